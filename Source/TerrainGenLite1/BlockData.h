@@ -21,6 +21,11 @@ struct FMask
 
     FMask(EBlock InBlockType, int InNormal)
         : BlockType(InBlockType), Normal(InNormal) {}
+
+    bool operator==(const FMask& Other) const
+    {
+        return BlockType == Other.BlockType && Normal == Other.Normal;
+    }
 };
 
 USTRUCT(BlueprintType)
@@ -51,10 +56,11 @@ public:
     float Humidity;
 
     FBlockData()
-        : Mask(), BlockCategory(EBlockCategory::Null), TextureIndex(-1), BiomeType(EBiome::Null), Humidity(0.5) {}
+        : Mask(), bIsSolid(false), BlockCategory(EBlockCategory::Null), TextureIndex(-1), BiomeType(EBiome::Null), Humidity(0.5) {}
 
     FBlockData(const FMask& InMask, EBlockCategory InBlockCategory, int InTextureIndex, EBiome InBiomeType, int InHumidity)
-        : Mask(InMask), BlockCategory(InBlockCategory), TextureIndex(InTextureIndex), BiomeType(InBiomeType), Humidity(InHumidity) {}
+        : Mask(InMask), bIsSolid(false), BlockCategory(InBlockCategory), TextureIndex(InTextureIndex), BiomeType(InBiomeType), Humidity(InHumidity) {}
+
 };
 
 
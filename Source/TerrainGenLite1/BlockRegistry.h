@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums.h"
+
+// Texture index used for blocks that are never drawn
+#define BLOCK_TEXTURE_NONE 255
+
+/**
+ * Static properties shared by every voxel of a block type.
+ *
+ * Face textures are ordered +X, +Y, +Z, -X, -Y, -Z so a quad's face can be looked up from its
+ * axis and normal sign without branching (see BlockRegistry::GetFaceIndex).
+ */
+struct FBlockDefinition
+{
+	EBlockCategory Category;
+
+	// Hides the faces of neighbouring blocks and takes part in the land mesh
+	bool bIsOpaque;
+
+	// Takes part in the liquid mesh
+	bool bIsLiquid;
+
+	float Hardness;
+
+	uint8 FaceTextures[6];
+
+	constexpr bool IsSolid() const { return Category == EBlockCategory::Solid; }
+
+	constexpr bool IsMeshed() const { return bIsOpaque || bIsLiquid; }
+};
+
+namespace BlockRegistry
+{
+	constexpr FBlockDefinition Uniform(const EBlockCategory Category, const bool bIsOpaque, const bool bIsLiquid, const float Hardness, const uint8 Texture)
+	{
+		return { Category, bIsOpaque, bIsLiquid, Hardness, { Texture, Texture, Texture, Texture, Texture, Texture } };
+	}
+
+	constexpr FBlockDefinition TopBottomSides(const EBlockCategory Category, const float Hardness, const uint8 Top, const uint8 Bottom, const uint8 Sides)
+	{
+		return { Category, true, false, Hardness, { Sides, Sides, Top, Sides, Sides, Bottom } };
+	}
+
+	// One entry per EBlock, in declaration order
+	inline constexpr FBlockDefinition Definitions[] =
+	{
+		/* Seeds        */ Uniform(EBlockCategory::NonSolid, true, false, 0.1f, 21),
+		/* Torch        */ Uniform(EBlockCategory::NonSolid, true, false, 0.1f, 22),
+		/* Grass        */ TopBottomSides(EBlockCategory::Solid, 0.2f, 0, 2, 1),
+		/* ShortGrass   */ Uniform(EBlockCategory::NonSolid, true, false, 0.1f, 20),
+		/* DryDirt      */ Uniform(EBlockCategory::Solid, true, false, 0.2f, 2),
+		/* WetDirt      */ Uniform(EBlockCategory::Solid, true, false, 0.2f, 17),
+		/* WetFarmland  */ TopBottomSides(EBlockCategory::Solid, 0.2f, 18, 17, 17),
+		/* DryFarmland  */ TopBottomSides(EBlockCategory::Solid, 0.2f, 19, 2, 2),
+		/* Stone        */ Uniform(EBlockCategory::Solid, true, false, 0.5f, 3),
+		/* Bedrock      */ Uniform(EBlockCategory::Solid, true, false, 1.0f, 4),
+		/* Log          */ TopBottomSides(EBlockCategory::Solid, 0.3f, 6, 6, 5),
+		/* WoodPlanks   */ Uniform(EBlockCategory::Solid, true, false, 0.3f, 7),
+		/* Leaves       */ Uniform(EBlockCategory::Solid, true, false, 0.1f, 8),
+		/* Sand         */ Uniform(EBlockCategory::Solid, true, false, 0.2f, 9),
+		/* Gravel       */ Uniform(EBlockCategory::Solid, true, false, 0.2f, 10),
+		/* ShallowWater */ Uniform(EBlockCategory::Liquid, false, true, 0.0f, 11),
+		/* DeepWater    */ Uniform(EBlockCategory::Liquid, false, true, 0.0f, 12),
+		/* Swamp        */ Uniform(EBlockCategory::Solid, true, false, 0.2f, 13),
+		/* Taiga        */ Uniform(EBlockCategory::Solid, true, false, 0.2f, 14),
+		/* Tundra       */ Uniform(EBlockCategory::Solid, true, false, 0.2f, 15),
+		/* Ice          */ Uniform(EBlockCategory::Solid, true, false, 0.3f, 16),
+		/* Air          */ Uniform(EBlockCategory::NonSolid, false, false, 0.0f, BLOCK_TEXTURE_NONE),
+		/* Null         */ Uniform(EBlockCategory::Null, false, false, 0.0f, BLOCK_TEXTURE_NONE),
+	};
+
+	static_assert(UE_ARRAY_COUNT(Definitions) == static_cast<int32>(EBlock::Null) + 1, "Every EBlock needs a registry entry");
+
+	constexpr const FBlockDefinition& Get(const EBlock Block)
+	{
+		return Definitions[static_cast<uint8>(Block)];
+	}
+
+	// Face index for a quad on Axis (0 = X, 1 = Y, 2 = Z) facing the positive or negative direction
+	constexpr int32 GetFaceIndex(const int32 Axis, const int32 Normal)
+	{
+		return Axis + (Normal < 0 ? 3 : 0);
+	}
+
+	constexpr uint8 GetFaceTexture(const EBlock Block, const int32 Axis, const int32 Normal)
+	{
+		return Get(Block).FaceTextures[GetFaceIndex(Axis, Normal)];
+	}
+}
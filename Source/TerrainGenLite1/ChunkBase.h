@@ -3,12 +3,11 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "ChunkMeshData.h"
+#include "ChunkData.h"
 #include "Enums.h"
 #include "BlockData.h"
-#include "FastNoiseLite.h"
 #include "ProceduralMeshComponent.h"
 #include "Math/Vector2D.h"
-#include <array>
 #include "ChunkBase.generated.h"
 
 
@@ -16,10 +15,10 @@
 #define ECC_LandMesh ECC_GameTraceChannel2
 #define ECC_WaterMesh ECC_GameTraceChannel3
 
-class FastNoiseLite;
 class UProceduralMeshComponent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnChunkMeshUpdated);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChunkVoxelsModified, AChunkBase*, Chunk, const TArray<FIntVector>&, Positions);
 
 UCLASS()
 class TERRAINGENLITE1_API AChunkBase: public AActor
@@ -37,6 +36,11 @@ public:
 	// Call this when the mesh is updated
 	void NotifyMeshUpdated();
 
+	// Broadcast once per frame after the queued voxel edits were remeshed, with the positions
+	// inside the chunk of every block they changed
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnChunkVoxelsModified OnChunkVoxelsModified;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Chunk")
 	int ChunkSize = 32;
 
@@ -52,9 +56,42 @@ public:
 	UPROPERTY(EditInstanceOnly, Category = "World")
 	int WaterLevel = 15;
 
+	EChunkMesher Mesher = EChunkMesher::BinaryGreedy;
+
+	// Chunk coordinate, in chunks, assigned by AChunkWorld before spawning finishes
+	FIntVector ChunkPosition = FIntVector::ZeroValue;
+
+	// Voxel and mesh buffers. Owned by the generation pipeline until OnGenerationComplete
+	TSharedPtr<FChunkData> GetChunkData() const { return ChunkData; }
+
+	// True once the generated meshes have been uploaded and the game thread owns the chunk data
+	bool IsGenerated() const { return bIsGenerated; }
+
+	// Game thread: uploads the meshes built by the generation pipeline
+	void OnGenerationComplete();
+
+	// Points the chunk at a new coordinate and clears its data for another generation pass
+	void ResetChunk(const FIntVector& InChunkPosition);
+
+	// Hides a streamed out chunk and drops its flora until the pool hands it out again
+	void DeactivateChunk();
+
+	// Edits are applied to the blocks immediately, the remesh and the update events are deferred
+	// to the end of the frame so any number of edits costs one remesh per chunk
 	UFUNCTION(BlueprintCallable, Category = "Chunk")
 	void ModifyVoxel(const FIntVector Position, const EBlock Block);
 
+	// Positions and Blocks are paired by index
+	UFUNCTION(BlueprintCallable, Category = "Chunk")
+	void ModifyVoxels(const TArray<FIntVector>& Positions, const TArray<EBlock>& Blocks);
+
+	// Remeshes the sections touched by the queued edits and broadcasts the updates
+	void FlushVoxelEdits();
+	bool HasPendingVoxelEdits() const { return PendingEditPositions.Num() > 0; }
+
+	// World-space box around the given chunk-local voxels, padded by a block for the faces of their neighbours
+	FBox GetVoxelBounds(const TArray<FIntVector>& Positions) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Chunk")
 	EBlock GetBlockType(const FIntVector Index) const;
 
@@ -66,36 +103,31 @@ public:
 
 	int GetBlockIndex(int X, int Y, int Z) const;
 
-	void GenerateMesh(bool isLandMesh);
-
-	FMask DetermineMask(const FBlockData& CurrentBlock, const FBlockData& CompareBlock, bool CurrentIsOpaque, bool CompareIsOpaque, bool CurrentIsLiquid, bool CompareIsLiquid, bool CurrentIsNonSolid, bool CompareIsNonSolid);
-
-	bool IsOpaque(EBlockCategory BlockCategory);
-
-	bool IsNonSolid(EBlockCategory BlockCategory);
+	// Block classification, looked up in BlockRegistry
+	bool IsOpaque(EBlock Block) const;
 
+	bool IsNonSolid(EBlock Block) const;
 
-	bool IsLiquid(EBlockCategory BlockCategory);
+	bool IsLiquid(EBlock Block) const;
 
-	void ClearMaskInBlockData(TArray<FBlockData>& BlockData, int N, int Width, int Height, int Axis1Limit);
-
-	int DetermineWidth(const TArray<FBlockData>& BlockData, int N, const FMask& CurrentMask, int Axis1Limit);
-
-	int DetermineHeight(const TArray<FBlockData>& BlockData, int N, const FMask& CurrentMask, int Width, int Axis1Limit, int Axis2Limit, int j);
-
-	// Sets the biome information for a specific block
-	void SetBiome(int32 X, int32 Y, int32 Z, EBiome BiomeType, float Humidity);
-
-	TArray<FBlockData> Blocks;
-
-	TArray<FIntVector> WaterBlockPositions;
+	UFUNCTION(BlueprintCallable, Category = "Chunk")
+	EBiome GetColumnBiome(int32 X, int32 Y) const;
 
-	void GenerateTrees(TArray<FIntVector> LocalTreePositions);
+	UFUNCTION(BlueprintCallable, Category = "Chunk")
+	float GetColumnHumidity(int32 X, int32 Y) const;
 
 	TArray<FDecorationData> GetFloraPositions() const;
 	//void GenerateFlora(TArray<FIntVector> LocalFloraPositions);
 
+	// Flora actors spawned for this chunk, destroyed together with it when it streams out
+	void AddDecorationActor(AActor* Actor);
+	void DestroyDecorationActors();
+
 	void RegenerateChunkBlockTextures();
+
+	// Remeshes and uploads only the sections marked dirty in the chunk data
+	void RemeshDirtySections();
+
 	int GetTextureIndex(EBlock Block, FVector Normal) const;
 
 
@@ -104,39 +136,35 @@ protected:
 	// Called when the game starts or when spawned
 	void BeginPlay() ;
 
-	void GenerateHeightMap(const FVector Position);
-	void GenerateWaterAndHumidity(const FVector Position);
-
-
-
 	void ModifyVoxelData(const FIntVector Position, const EBlock Block);
+
 	TObjectPtr<UProceduralMeshComponent> LandMesh;
 	TObjectPtr<UProceduralMeshComponent> LiquidMesh;
-	TUniquePtr<FastNoiseLite> Noise;
-	FChunkMeshData LandMeshData;
-	FChunkMeshData LiquidMeshData;
-	int LandVertexCount = 0;
-	int LiquidVertexCount = 0;
+	TSharedPtr<FChunkData> ChunkData;
+	bool bIsGenerated = false;
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> DecorationActors;
 
 	FCollisionResponseContainer LandMeshResponse;
 	FCollisionResponseContainer WaterMeshResponse;
 
 private:
-	void ApplyMesh(bool isLandMesh) const;
-	void ClearMesh(bool isLandMesh);
-	void GenerateChunk();
-
-	void CreateQuad(const FBlockData BlockData, const FIntVector AxisMask, int Width, int Height, const FIntVector V1, const FIntVector V2, const FIntVector V3, const FIntVector V4, FChunkMeshData& MeshData, int& VertexCount);
+	// Sets the block and queues the end of frame flush, returns false if nothing changed
+	bool ApplyVoxelEdit(const FIntVector& Position, EBlock Block);
 
-	std::array<FVector2D, 4> GetUVMapping(const FBlockData& BlockData, const FVector& NormalVector, int Width, int Height);
+	// Positions changed since the last flush
+	TArray<FIntVector> PendingEditPositions;
+	FTimerHandle VoxelEditFlushHandle;
 
-	bool CompareMask(FMask M1, FMask M2) const;
+	// Uploads every section of the land or liquid mesh
+	void ApplyMesh(bool isLandMesh);
+	void ApplySection(bool isLandMesh, int32 SectionIndex);
 
-	TArray<FIntVector> TreePositions;
-	TArray<FDecorationData> FloraPositions;
+	// Scratch section the packed meshes are unpacked into, reused across uploads
+	FProcMeshSection UploadSection;
 
 	void PrintMeshData(bool isLandMesh) const;
-	void UpdateWaterMesh();
 
 };
 
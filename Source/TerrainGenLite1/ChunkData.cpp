@@ -0,0 +1,1238 @@
+#include "ChunkData.h"
+
+#include "BlockRegistry.h"
+#include "FeatureHash.h"
+#include "VoxelStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Chunk Decoration"), STAT_VoxelDecoration, STATGROUP_Voxel);
+
+void FChunkMeshSection::Clear()
+{
+	LandMeshData.Clear();
+	LiquidMeshData.Clear();
+	LandVertexCount = 0;
+	LiquidVertexCount = 0;
+	BorderFaceCount = 0;
+	CulledBorderFaceCount = 0;
+}
+
+FChunkData::FChunkData(const FIntVector& InChunkPosition, const int32 InChunkSize, const int32 InWaterLevel)
+	: ChunkPosition(InChunkPosition),
+	ChunkSize(InChunkSize),
+	WaterLevel(InWaterLevel)
+{
+	// Packed vertices store chunk-local corners in 6 bits
+	checkf(ChunkSize <= FChunkVertex::MaxCoordinate, TEXT("Chunk size %d does not fit the packed vertex format"), ChunkSize);
+
+	Blocks.Init(ChunkSize * ChunkSize * ChunkSize, EBlock::Null);
+	BiomeMap.Init(EBiome::Null, ChunkSize * ChunkSize);
+	HumidityMap.Init(0.5f, ChunkSize * ChunkSize);
+
+	// The dirty mask holds one bit per section
+	MeshSections.SetNum(FMath::DivideAndRoundUp(ChunkSize, SectionHeight));
+	check(MeshSections.Num() <= 32);
+
+	for (TArray<EBlock>& HaloFace : Halo)
+	{
+		HaloFace.Init(EBlock::Air, ChunkSize * ChunkSize);
+	}
+}
+
+void FChunkData::Reset(const FIntVector& InChunkPosition)
+{
+	ChunkPosition = InChunkPosition;
+
+	Blocks.Fill(EBlock::Null);
+	for (int32 i = 0; i < BiomeMap.Num(); ++i)
+	{
+		BiomeMap[i] = EBiome::Null;
+		HumidityMap[i] = 0.5f;
+	}
+
+	Column.Reset();
+	WaterBlockPositions.Reset();
+	TreePositions.Reset();
+	FloraPositions.Reset();
+	OverflowFeatureBlocks.Reset();
+	IncomingFeatureBlocks.Reset();
+	FeatureSources.Reset();
+
+	ClearMesh(true);
+	ClearMesh(false);
+
+	for (int32 Face = 0; Face < 6; ++Face)
+	{
+		ClearHaloFace(Face);
+	}
+	DirtySectionMask = 0;
+
+	Timings = FChunkGenerationTimings();
+	Contents = EChunkContents::Mixed;
+	bIsRestored = false;
+	bHasUnsavedEdits = false;
+}
+
+void FChunkData::UpdateContents()
+{
+	Contents = EChunkContents::Mixed;
+	if (!Blocks.IsUniform())
+		return;
+
+	const EBlock Block = Blocks.Get(0);
+	if (Block == EBlock::Air)
+	{
+		Contents = EChunkContents::Empty;
+	}
+	else if (BlockRegistry::Get(Block).bIsOpaque)
+	{
+		Contents = EChunkContents::Solid;
+	}
+}
+
+void FChunkData::SetBlock(const FIntVector& Position, const EBlock Block)
+{
+	// Not reclassified, an edit that makes the chunk uniform again only costs the skipped work
+	Blocks.Set(GetBlockIndex(Position.X, Position.Y, Position.Z), Block);
+	Contents = EChunkContents::Mixed;
+	bHasUnsavedEdits = true;
+}
+
+int FChunkData::GetBlockIndex(const int X, const int Y, const int Z) const
+{
+	return Z * ChunkSize * ChunkSize + Y * ChunkSize + X;
+}
+
+int FChunkData::GetColumnIndex(const int X, const int Y) const
+{
+	return Y * ChunkSize + X;
+}
+
+bool FChunkData::IsInsideChunk(const FIntVector& Index) const
+{
+	return Index.X >= 0 && Index.Y >= 0 && Index.Z >= 0 && Index.X < ChunkSize && Index.Y < ChunkSize && Index.Z < ChunkSize;
+}
+
+EBlock FChunkData::GetBlockType(const FIntVector& Index) const
+{
+	if (!IsInsideChunk(Index))
+		return EBlock::Air;
+	return Blocks.Get(GetBlockIndex(Index.X, Index.Y, Index.Z));
+}
+
+EBlock FChunkData::GetPaddedBlockType(const FIntVector& Index) const
+{
+	int32 Face = INDEX_NONE;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (Index[Axis] >= 0 && Index[Axis] < ChunkSize)
+			continue;
+
+		// Only one voxel past a single face is padded
+		if (Face != INDEX_NONE || (Index[Axis] != -1 && Index[Axis] != ChunkSize))
+			return EBlock::Air;
+
+		Face = BlockRegistry::GetFaceIndex(Axis, Index[Axis] < 0 ? -1 : 1);
+	}
+
+	if (Face == INDEX_NONE)
+		return Blocks.Get(GetBlockIndex(Index.X, Index.Y, Index.Z));
+
+	return Halo[Face][GetHaloIndex(Face % 3, Index)];
+}
+
+int FChunkData::GetHaloIndex(const int32 Axis, const FIntVector& Index) const
+{
+	return Index[(Axis + 2) % 3] * ChunkSize + Index[(Axis + 1) % 3];
+}
+
+void FChunkData::CopyHaloFace(const int32 Face, const FChunkData& Neighbour)
+{
+	const int32 Axis = Face % 3;
+	const int32 Axis1 = (Axis + 1) % 3;
+	const int32 Axis2 = (Axis + 2) % 3;
+
+	// The halo past our positive face is the neighbour's first layer, and the other way round
+	FIntVector Position = FIntVector::ZeroValue;
+	Position[Axis] = Face < 3 ? 0 : ChunkSize - 1;
+
+	TArray<EBlock>& HaloFace = Halo[Face];
+	for (Position[Axis2] = 0; Position[Axis2] < ChunkSize; ++Position[Axis2])
+	{
+		for (Position[Axis1] = 0; Position[Axis1] < ChunkSize; ++Position[Axis1])
+		{
+			HaloFace[GetHaloIndex(Axis, Position)] = Neighbour.Blocks.Get(Neighbour.GetBlockIndex(Position.X, Position.Y, Position.Z));
+		}
+	}
+
+	HaloFaceMask |= 1 << Face;
+
+	// The Z faces only border the bottom or the top section
+	if (Face == 2)
+		DirtySectionMask |= 1u << (MeshSections.Num() - 1);
+	else if (Face == 5)
+		DirtySectionMask |= 1u;
+	else
+		MarkAllSectionsDirty();
+}
+
+bool FChunkData::RefreshHaloFace(const int32 Face, const FChunkData& Neighbour)
+{
+	const int32 Axis = Face % 3;
+	const int32 Axis1 = (Axis + 1) % 3;
+	const int32 Axis2 = (Axis + 2) % 3;
+
+	FIntVector Position = FIntVector::ZeroValue;
+	Position[Axis] = Face < 3 ? 0 : ChunkSize - 1;
+
+	bool bChanged = false;
+	TArray<EBlock>& HaloFace = Halo[Face];
+	for (Position[Axis2] = 0; Position[Axis2] < ChunkSize; ++Position[Axis2])
+	{
+		for (Position[Axis1] = 0; Position[Axis1] < ChunkSize; ++Position[Axis1])
+		{
+			const EBlock Block = Neighbour.Blocks.Get(Neighbour.GetBlockIndex(Position.X, Position.Y, Position.Z));
+			EBlock& HaloBlock = HaloFace[GetHaloIndex(Axis, Position)];
+			if (HaloBlock != Block)
+			{
+				HaloBlock = Block;
+				bChanged = true;
+
+				// Only the section level with the halo voxel meshes faces against it
+				const int32 Z = Face == 2 ? ChunkSize - 1 : (Face == 5 ? 0 : Position.Z);
+				DirtySectionMask |= 1u << GetSectionIndex(Z);
+			}
+		}
+	}
+
+	HaloFaceMask |= 1 << Face;
+	return bChanged;
+}
+
+void FChunkData::ClearHaloFace(const int32 Face)
+{
+	for (EBlock& Block : Halo[Face])
+	{
+		Block = EBlock::Air;
+	}
+
+	HaloFaceMask &= ~(1 << Face);
+}
+
+int32 FChunkData::GetBorderFaceCount() const
+{
+	int32 Count = 0;
+	for (const FChunkMeshSection& Section : MeshSections)
+	{
+		Count += Section.BorderFaceCount;
+	}
+	return Count;
+}
+
+int32 FChunkData::GetCulledBorderFaceCount() const
+{
+	int32 Count = 0;
+	for (const FChunkMeshSection& Section : MeshSections)
+	{
+		Count += Section.CulledBorderFaceCount;
+	}
+	return Count;
+}
+
+void FChunkData::MarkVoxelDirty(const FIntVector& Position)
+{
+	const int32 SectionIndex = GetSectionIndex(Position.Z);
+	DirtySectionMask |= 1u << SectionIndex;
+
+	// Faces on a section boundary are meshed by the section owning the visible voxel, which may be either
+	const int32 LocalZ = Position.Z - SectionIndex * SectionHeight;
+	if (LocalZ == 0 && SectionIndex > 0)
+		DirtySectionMask |= 1u << (SectionIndex - 1);
+	if (LocalZ == SectionHeight - 1 && SectionIndex + 1 < MeshSections.Num())
+		DirtySectionMask |= 1u << (SectionIndex + 1);
+}
+
+void FChunkData::MarkAllSectionsDirty()
+{
+	DirtySectionMask = (1u << MeshSections.Num()) - 1;
+}
+
+EBiome FChunkData::GetColumnBiome(const int32 X, const int32 Y) const
+{
+	if (X >= ChunkSize || Y >= ChunkSize || X < 0 || Y < 0)
+		return EBiome::Null;
+	return BiomeMap[GetColumnIndex(X, Y)];
+}
+
+float FChunkData::GetColumnHumidity(const int32 X, const int32 Y) const
+{
+	if (X >= ChunkSize || Y >= ChunkSize || X < 0 || Y < 0)
+		return 0.0f;
+	return HumidityMap[GetColumnIndex(X, Y)];
+}
+
+void FChunkData::SetColumnBiome(int32 X, int32 Y, EBiome BiomeType, float Humidity, int32 WorldSeed)
+{
+	const int ColumnIndex = GetColumnIndex(X, Y);
+	BiomeMap[ColumnIndex] = BiomeType;
+	HumidityMap[ColumnIndex] = Humidity;
+
+	// Uniform chunks are all air or all stone, which no biome converts, and restored blocks were converted before they were saved
+	if (Contents != EChunkContents::Mixed || bIsRestored)
+		return;
+
+	// Apply the biome to every block of the column
+	for (int32 Z = 0; Z < ChunkSize; ++Z)
+	{
+		ApplyBiome(X, Y, Z, BiomeType, WorldSeed);
+	}
+}
+
+void FChunkData::ApplyBiome(int32 X, int32 Y, int32 Z, EBiome BiomeType, int32 WorldSeed)
+{
+	const int Index = GetBlockIndex(X, Y, Z);
+	EBlock Block = Blocks.Get(Index);
+
+	// Decorations roll on the world block, so they come out the same in every run and generation order
+	const FIntVector WorldBlock = ChunkPosition * ChunkSize + FIntVector(X, Y, Z);
+
+	switch (BiomeType)
+	{
+	case EBiome::Null:
+
+		break;
+	case EBiome::Desert:
+		if (Block == EBlock::Grass || Block == EBlock::DryDirt)
+		{
+			Block = EBlock::Sand;
+		}
+
+		if (Block == EBlock::ShallowWater || Block == EBlock::DeepWater)
+		{
+			Block = EBlock::Sand;
+		}
+		break;
+	case EBiome::Swamp:
+		if (Block == EBlock::Grass && FFeatureHash::Roll(WorldSeed, WorldBlock, EDecorationFeature::Tree, 80) == 0)
+		{
+			TreePositions.Add(FIntVector(X, Y, Z));
+		}
+		if (Block == EBlock::Grass)
+		{
+			Block = EBlock::Swamp;
+		}
+		if (Block == EBlock::Sand && Z < GetLocalWaterLevel())
+		{
+			Block = EBlock::WetDirt;
+		}
+		break;
+	case EBiome::Tundra:
+		if (Block == EBlock::Grass || Block == EBlock::Sand)
+		{
+			Block = EBlock::Tundra;
+		}
+		if (Block == EBlock::ShallowWater || Block == EBlock::DeepWater)
+		{
+			Block = EBlock::Ice;
+		}
+		break;
+	case EBiome::Taiga:
+		if (Block == EBlock::Grass && FFeatureHash::Roll(WorldSeed, WorldBlock, EDecorationFeature::Tree, 30) == 0)
+		{
+			TreePositions.Add(FIntVector(X, Y, Z));
+		}
+		if (Block == EBlock::Grass)
+		{
+			Block = EBlock::Taiga;
+		}
+		if (Block == EBlock::Sand)
+		{
+			Block = EBlock::Gravel;
+		}
+		break;
+	case EBiome::Plains:
+		if (Block == EBlock::Grass)
+		{
+			if (FFeatureHash::Roll(WorldSeed, WorldBlock, EDecorationFeature::Tree, 100) == 0)
+			{
+				TreePositions.Add(FIntVector(X, Y, Z));
+			}
+			else
+			{
+				// Three in seven grass blocks
+				if (FFeatureHash::Roll(WorldSeed, WorldBlock, EDecorationFeature::Flora, 7) < 3)
+				{
+					
+					FDecorationData DecorationData;
+					DecorationData.Position = FIntVector(X, Y, Z + 1);
+					DecorationData.DecorationBlockType = EBlock::ShortGrass;
+					DecorationData.TextureIndex = 20;
+
+					FloraPositions.Add(DecorationData);
+				}
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	Blocks.Set(Index, Block);
+}
+
+/**
+ * @brief Generates a mesh using the greedy meshing algorithm.
+ *
+ * This function iterates over each axis of the chunk (X, Y, Z) and creates
+ * quads for the visible faces of the blocks. It reduces the number of polygons
+ * by merging adjacent blocks that share the same properties.
+ */
+void FChunkData::GenerateMesh()
+{
+	for (int32 SectionIndex = 0; SectionIndex < MeshSections.Num(); ++SectionIndex)
+	{
+		GenerateSectionMesh(SectionIndex);
+	}
+	DirtySectionMask = 0;
+}
+
+void FChunkData::GenerateSectionMesh(const int32 SectionIndex)
+{
+	FChunkMeshSection& Section = MeshSections[SectionIndex];
+	const int32 MinZ = SectionIndex * SectionHeight;
+	const int32 MaxZ = FMath::Min(MinZ + SectionHeight, ChunkSize);
+
+	Section.Clear();
+
+	// Nothing inside a uniform chunk has a face, only a Solid one bordering open halo voxels does
+	if (Contents == EChunkContents::Empty || (Contents == EChunkContents::Solid && !IsSectionExposed(SectionIndex)))
+		return;
+
+	// Padded columns need two bits on top of the chunk size
+	if (Mesher == EChunkMesher::BinaryGreedy && ChunkSize <= 62)
+	{
+		GenerateBinaryGreedyMesh(Section, MinZ, MaxZ);
+		return;
+	}
+
+	GenerateGreedyMesh(Section, MinZ, MaxZ);
+}
+
+void FChunkData::GenerateGreedyMesh(FChunkMeshSection& Section, const int32 MinZ, const int32 MaxZ)
+{
+	// Loop through the three axes
+	for (int Axis = 0; Axis < 3; ++Axis)
+	{
+		const int Axis1 = (Axis + 1) % 3;
+		const int Axis2 = (Axis + 2) % 3;
+
+		// Along Z only the slices of the section are meshed, the other axes skip cells outside of it
+		const int MainAxisStart = Axis == 2 ? MinZ : 0;
+		const int MainAxisLimit = Axis == 2 ? MaxZ : ChunkSize;
+		const int Axis1Limit = ChunkSize;
+		const int Axis2Limit = ChunkSize;
+
+		auto DeltaAxis1 = FIntVector::ZeroValue;
+		auto DeltaAxis2 = FIntVector::ZeroValue;
+
+		auto ChunkItr = FIntVector::ZeroValue;
+		auto AxisMask = FIntVector::ZeroValue;
+		AxisMask[Axis] = 1;
+
+		// Iterate through each block in the chunk
+		TArray<FBlockData> BlockData;
+		BlockData.SetNum(Axis1Limit * Axis2Limit);
+
+		for (ChunkItr[Axis] = MainAxisStart - 1; ChunkItr[Axis] < MainAxisLimit;)
+		{
+			int N = 0;
+
+			// On the border planes only the faces of our own voxels are meshed, the neighbour (or the
+			// neighbouring section) meshes its side
+			const bool bIsLowerBorder = ChunkItr[Axis] == MainAxisStart - 1;
+			const bool bIsUpperBorder = ChunkItr[Axis] == MainAxisLimit - 1;
+			const bool bIsChunkBorder = ChunkItr[Axis] == -1 || ChunkItr[Axis] == ChunkSize - 1;
+
+			// Iterate through Axis2 and Axis1
+			for (ChunkItr[Axis2] = 0; ChunkItr[Axis2] < Axis2Limit; ++ChunkItr[Axis2])
+			{
+				for (ChunkItr[Axis1] = 0; ChunkItr[Axis1] < Axis1Limit; ++ChunkItr[Axis1])
+				{
+					if (Axis != 2 && (ChunkItr.Z < MinZ || ChunkItr.Z >= MaxZ))
+					{
+						BlockData[N++].Mask = FMask{ EBlock::Null, 0 };
+						continue;
+					}
+
+					const auto CurrentBlock = GetPaddedBlockType(ChunkItr);
+					const auto CompareBlock = GetPaddedBlockType(ChunkItr + AxisMask);
+
+					// Determine if the current and compare blocks are opaque or liquid
+					const FBlockDefinition& Current = BlockRegistry::Get(CurrentBlock);
+					const FBlockDefinition& Compare = BlockRegistry::Get(CompareBlock);
+
+					const bool CurrentBlockIsOpaque = Current.bIsOpaque;
+					const bool CompareBlockIsOpaque = Compare.bIsOpaque;
+
+					const bool CurrentBlockIsLiquid = Current.bIsLiquid;
+					const bool CompareBlockIsLiquid = Compare.bIsLiquid;
+
+					if (CurrentBlockIsOpaque && CompareBlockIsLiquid)
+					{
+						// Current block is land, compare block is water: prioritize land
+						BlockData[N++].Mask = FMask{ CurrentBlock, 1 };
+					}
+					else if (CurrentBlockIsLiquid && CompareBlockIsOpaque)
+					{
+						// Current block is water, compare block is land: prioritize land
+						BlockData[N++].Mask = FMask{ CompareBlock, -1 };
+					}
+					else if (CurrentBlockIsOpaque == CompareBlockIsOpaque && CurrentBlockIsLiquid == CompareBlockIsLiquid)
+					{
+						// Both blocks are of the same type (either both land or both water)
+						BlockData[N++].Mask = FMask{ EBlock::Null, 0 };
+					}
+					else if (CurrentBlockIsOpaque)
+					{
+						// Only current block is opaque
+						BlockData[N++].Mask = FMask{ CurrentBlock, 1 };
+					}
+					else if (CurrentBlockIsLiquid)
+					{
+						// Only current block is liquid
+						BlockData[N++].Mask = FMask{ CurrentBlock, 1 };
+					}
+					else
+					{
+						// Default case: use the compare block type
+						BlockData[N++].Mask = FMask{ CompareBlock, -1 };
+					}
+
+					if (bIsLowerBorder || bIsUpperBorder)
+					{
+						FMask& Mask = BlockData[N - 1].Mask;
+						if ((bIsLowerBorder && Mask.Normal == 1) || (bIsUpperBorder && Mask.Normal == -1))
+						{
+							Mask = FMask{ EBlock::Null, 0 };
+						}
+
+						// Against Air every meshed border voxel would have shown a face
+						const EBlock BorderBlock = bIsLowerBorder ? CompareBlock : CurrentBlock;
+						if (bIsChunkBorder && BlockRegistry::Get(BorderBlock).IsMeshed())
+						{
+							if (Mask.Normal != 0)
+								++Section.BorderFaceCount;
+							else
+								++Section.CulledBorderFaceCount;
+						}
+					}
+				}
+			}
+
+			// Increment ChunkItr[Axis] and reset N
+			++ChunkItr[Axis];
+			N = 0;
+
+			// Loop through Axis2Limit and Axis1Limit
+			for (int j = 0; j < Axis2Limit; ++j)
+			{
+				for (int i = 0; i < Axis1Limit;)
+				{
+					if (BlockData[N].Mask.Normal != 0)
+					{
+						const auto& CurrentMask = BlockData[N];
+						ChunkItr[Axis1] = i;
+						ChunkItr[Axis2] = j;
+
+						int Width;
+
+						for (Width = 1; i + Width < Axis1Limit && CompareMask(BlockData[N + Width].Mask, CurrentMask.Mask); ++Width)
+						{
+						}
+
+						int Height;
+						bool Done = false;
+
+						for (Height = 1; j + Height < Axis2Limit; ++Height)
+						{
+							for (int k = 0; k < Width; ++k)
+							{
+								if (CompareMask(BlockData[N + k + Height * Axis1Limit].Mask, CurrentMask.Mask)) continue;
+
+								Done = true;
+								break;
+							}
+
+							if (Done) break;
+						}
+
+						DeltaAxis1[Axis1] = Width;
+						DeltaAxis2[Axis2] = Height;
+
+						// Route water faces to the liquid mesh and everything else to the land mesh
+						const bool isWaterBlock = BlockRegistry::Get(CurrentMask.Mask.BlockType).bIsLiquid;
+
+						CreateQuad(
+							CurrentMask,
+							AxisMask,
+							Width,
+							Height,
+							ChunkItr,
+							ChunkItr + DeltaAxis1,
+							ChunkItr + DeltaAxis2,
+							ChunkItr + DeltaAxis1 + DeltaAxis2,
+							isWaterBlock ? Section.LiquidMeshData : Section.LandMeshData,
+							isWaterBlock ? Section.LiquidVertexCount : Section.LandVertexCount
+						);
+
+						DeltaAxis1 = FIntVector::ZeroValue;
+						DeltaAxis2 = FIntVector::ZeroValue;
+
+						for (int l = 0; l < Height; ++l)
+						{
+							for (int k = 0; k < Width; ++k)
+							{
+								BlockData[N + k + l * Axis1Limit].Mask = FMask{ EBlock::Null, 0 };
+							}
+						}
+
+						i += Width;
+						N += Width;
+					}
+					else
+					{
+						i++;
+						N++;
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Creates a quad and adds it to the mesh data.
+ *
+ * This function handles the vertices, normals, colors, and UV coordinates for
+ * the quad based on the specified dimensions and vertex positions.
+ *
+ * @param Mask The mask containing block type and normal direction.
+ * @param AxisMask The mask indicating the current axis being processed.
+ * @param Width The width of the quad.
+ * @param Height The height of the quad.
+ * @param V1 The first vertex position of the quad.
+ * @param V2 The second vertex position of the quad.
+ * @param V3 The third vertex position of the quad.
+ * @param V4 The fourth vertex position of the quad.
+ */
+void FChunkData::CreateQuad(
+	const FBlockData BlockData,
+	const FIntVector AxisMask,
+	int Width,
+	int Height,
+	const FIntVector V1,
+	const FIntVector V2,
+	const FIntVector V3,
+	const FIntVector V4,
+	FChunkMeshData& MeshData,
+	int& VertexCount
+)
+{
+	// Skip empty or non-existent blocks
+	if (!BlockRegistry::Get(BlockData.Mask.BlockType).IsMeshed())
+	{
+		return;
+	}
+
+	// Pack the corners, the normal and UVs are rebuilt from the face and quad size on upload
+	const int Axis = AxisMask.Y + AxisMask.Z * 2;
+	const int Face = BlockRegistry::GetFaceIndex(Axis, BlockData.Mask.Normal);
+	const uint8 TextureLayer = BlockRegistry::GetFaceTexture(BlockData.Mask.BlockType, Axis, BlockData.Mask.Normal);
+
+	MeshData.Vertices.Append({
+		FChunkVertex::Pack(V1, Face, 0, TextureLayer, Width, Height),
+		FChunkVertex::Pack(V2, Face, 1, TextureLayer, Width, Height),
+		FChunkVertex::Pack(V3, Face, 2, TextureLayer, Width, Height),
+		FChunkVertex::Pack(V4, Face, 3, TextureLayer, Width, Height)
+		});
+
+	// Define triangles
+	MeshData.Triangles.Append({
+		VertexCount,
+		VertexCount + 2 + BlockData.Mask.Normal,
+		VertexCount + 2 - BlockData.Mask.Normal,
+		VertexCount + 3,
+		VertexCount + 1 - BlockData.Mask.Normal,
+		VertexCount + 1 + BlockData.Mask.Normal
+		});
+
+	VertexCount += 4; // Increment for 4 new vertices added
+}
+
+void FChunkData::GenerateBinaryGreedyMesh(FChunkMeshSection& Section, const int32 MinZ, const int32 MaxZ)
+{
+	const int Size = ChunkSize;
+	const int ColumnsPerAxis = Size * Size;
+
+	// Block types present in the chunk and its halo, mapped to small local ids
+	int8 LocalIds[UE_ARRAY_COUNT(BlockRegistry::Definitions)];
+	FMemory::Memset(LocalIds, 0xff, sizeof(LocalIds));
+	TArray<EBlock, TInlineAllocator<16>> LocalTypes;
+
+	// One column per (Axis1, Axis2) cell and axis, bit 0 and bit Size + 1 hold the halo. The scratch
+	// buffers are kept per thread, so meshing another section reuses their allocations
+	static thread_local TArray<uint64> TypeColumns;
+	TypeColumns.Reset();
+	auto GetLocalId = [&](const EBlock Block)
+	{
+		int8& LocalId = LocalIds[static_cast<int32>(Block)];
+		if (LocalId < 0)
+		{
+			LocalId = static_cast<int8>(LocalTypes.Add(Block));
+			TypeColumns.AddZeroed(3 * ColumnsPerAxis);
+		}
+		return LocalId;
+	};
+	auto GetColumn = [&](const int32 LocalId, const int32 Axis, const int32 Column) -> uint64&
+	{
+		return TypeColumns[(LocalId * 3 + Axis) * ColumnsPerAxis + Column];
+	};
+
+	// Columns along X are indexed by (Y, Z), along Y by (Z, X) and along Z by (X, Y), matching Axis1 and Axis2.
+	// Only the section and the layer on either side of it are read
+	const int FirstZ = FMath::Max(MinZ - 1, 0);
+	const int LastZ = FMath::Min(MaxZ, Size - 1);
+	int BlockIndex = GetBlockIndex(0, 0, FirstZ);
+	for (int z = FirstZ; z <= LastZ; ++z)
+	{
+		for (int y = 0; y < Size; ++y)
+		{
+			for (int x = 0; x < Size; ++x)
+			{
+				const int32 LocalId = GetLocalId(Blocks.Get(BlockIndex++));
+				GetColumn(LocalId, 0, z * Size + y) |= uint64(1) << (x + 1);
+				GetColumn(LocalId, 1, x * Size + z) |= uint64(1) << (y + 1);
+				GetColumn(LocalId, 2, y * Size + x) |= uint64(1) << (z + 1);
+			}
+		}
+	}
+
+	// Halo slabs use the same (Axis1, Axis2) layout as the columns
+	for (int32 Face = 0; Face < 6; ++Face)
+	{
+		const uint64 HaloBit = uint64(1) << (Face < 3 ? Size + 1 : 0);
+		for (int Column = 0; Column < ColumnsPerAxis; ++Column)
+		{
+			GetColumn(GetLocalId(Halo[Face][Column]), Face % 3, Column) |= HaloBit;
+		}
+	}
+
+	const int NumTypes = LocalTypes.Num();
+	const int NumKeys = NumTypes * 2;
+
+	// Bits Low to High inclusive
+	auto GetBitRange = [](const int Low, const int High)
+	{
+		return ((uint64(1) << (High + 1)) - 1) & ~((uint64(1) << Low) - 1);
+	};
+
+	// Bit b of a face column is the face between column bits b and b + 1, i.e. voxels b - 1 and b, placed
+	// on slice b. On the border slices of the chunk or section only the faces of our own voxels are kept
+	const uint64 LowerBorderBit = uint64(1) << 1;
+	const uint64 UpperBorderBit = uint64(1) << Size;
+
+	// Face rows per slice and mask, a row is indexed by Axis2 and holds one bit per Axis1 cell
+	static thread_local TArray<uint64> Planes;
+
+	for (int Axis = 0; Axis < 3; ++Axis)
+	{
+		const int Axis1 = (Axis + 1) % 3;
+		const int Axis2 = (Axis + 2) % 3;
+
+		auto AxisMask = FIntVector::ZeroValue;
+		AxisMask[Axis] = 1;
+
+		const int MainAxisStart = Axis == 2 ? MinZ : 0;
+		const int MainAxisLimit = Axis == 2 ? MaxZ : Size;
+		const uint64 PositiveFaceBits = GetBitRange(MainAxisStart + 1, MainAxisLimit);
+		const uint64 NegativeFaceBits = GetBitRange(MainAxisStart, MainAxisLimit - 1);
+		const bool bHasLowerChunkBorder = MainAxisStart == 0;
+		const bool bHasUpperChunkBorder = MainAxisLimit == Size;
+
+		Planes.Reset();
+		Planes.AddZeroed((Size + 1) * NumKeys * Size);
+		auto GetRow = [&](const int Slice, const int Key, const int Row) -> uint64&
+		{
+			return Planes[(Slice * NumKeys + Key) * Size + Row];
+		};
+
+		for (int Column = 0; Column < ColumnsPerAxis; ++Column)
+		{
+			// Columns along X and Y cross every section, skip the cells of the other ones
+			if ((Axis == 0 && (Column / Size < MinZ || Column / Size >= MaxZ)) ||
+				(Axis == 1 && (Column % Size < MinZ || Column % Size >= MaxZ)))
+				continue;
+
+			uint64 Opaque = 0;
+			uint64 Liquid = 0;
+			for (int32 LocalId = 0; LocalId < NumTypes; ++LocalId)
+			{
+				const FBlockDefinition& Definition = BlockRegistry::Get(LocalTypes[LocalId]);
+				if (Definition.bIsOpaque)
+					Opaque |= GetColumn(LocalId, Axis, Column);
+				else if (Definition.bIsLiquid)
+					Liquid |= GetColumn(LocalId, Axis, Column);
+			}
+			const uint64 Empty = ~(Opaque | Liquid);
+
+			// Land wins over liquid, both win over air, same as the mask rules of the cell by cell mesher
+			const uint64 PositiveFaces = ((Opaque & ~(Opaque >> 1)) | (Liquid & (Empty >> 1))) & PositiveFaceBits;
+			const uint64 NegativeFaces = (((Opaque >> 1) & ~Opaque) | ((Liquid >> 1) & Empty)) & NegativeFaceBits;
+
+			// Against Air every meshed border voxel would have shown a face
+			const uint64 Meshed = Opaque | Liquid;
+			const int LowerFaces = bHasLowerChunkBorder && (NegativeFaces & 1) ? 1 : 0;
+			const int UpperFaces = bHasUpperChunkBorder && (PositiveFaces & UpperBorderBit) ? 1 : 0;
+			const int LowerCandidates = bHasLowerChunkBorder && (Meshed & LowerBorderBit) ? 1 : 0;
+			const int UpperCandidates = bHasUpperChunkBorder && (Meshed & UpperBorderBit) ? 1 : 0;
+			Section.BorderFaceCount += LowerFaces + UpperFaces;
+			Section.CulledBorderFaceCount += LowerCandidates - LowerFaces + UpperCandidates - UpperFaces;
+
+			const int A1 = Column % Size;
+			const int A2 = Column / Size;
+			const uint64 CellBit = uint64(1) << A1;
+
+			for (int32 LocalId = 0; LocalId < NumTypes; ++LocalId)
+			{
+				const uint64 TypeColumn = GetColumn(LocalId, Axis, Column);
+
+				// Positive faces belong to the voxel before the face, negative ones to the voxel after it
+				for (uint64 Bits = PositiveFaces & TypeColumn; Bits; Bits &= Bits - 1)
+				{
+					GetRow(FMath::CountTrailingZeros64(Bits), LocalId * 2, A2) |= CellBit;
+				}
+				for (uint64 Bits = NegativeFaces & (TypeColumn >> 1); Bits; Bits &= Bits - 1)
+				{
+					GetRow(FMath::CountTrailingZeros64(Bits), LocalId * 2 + 1, A2) |= CellBit;
+				}
+			}
+		}
+
+		// Greedy merge in the same row-major order as the cell by cell mesher
+		auto ChunkItr = FIntVector::ZeroValue;
+		auto DeltaAxis1 = FIntVector::ZeroValue;
+		auto DeltaAxis2 = FIntVector::ZeroValue;
+
+		const int FirstRow = Axis == 0 ? MinZ : 0;
+		const int RowLimit = Axis == 0 ? MaxZ : Size;
+
+		for (int Slice = MainAxisStart; Slice <= MainAxisLimit; ++Slice)
+		{
+			ChunkItr[Axis] = Slice;
+
+			for (int j = FirstRow; j < RowLimit; ++j)
+			{
+				while (true)
+				{
+					uint64 AnyFaces = 0;
+					for (int Key = 0; Key < NumKeys; ++Key)
+					{
+						AnyFaces |= GetRow(Slice, Key, j);
+					}
+					if (!AnyFaces)
+						break;
+
+					// A cell holds at most one face, find the mask it belongs to
+					const int i = FMath::CountTrailingZeros64(AnyFaces);
+					int Key = 0;
+					while (!(GetRow(Slice, Key, j) & (uint64(1) << i)))
+					{
+						++Key;
+					}
+
+					const uint64 Run = ~(GetRow(Slice, Key, j) >> i);
+					const int Width = Run ? FMath::CountTrailingZeros64(Run) : 64 - i;
+					const uint64 RunMask = (Width >= 64 ? ~uint64(0) : ((uint64(1) << Width) - 1)) << i;
+
+					int Height = 1;
+					while (j + Height < RowLimit && (GetRow(Slice, Key, j + Height) & RunMask) == RunMask)
+					{
+						++Height;
+					}
+
+					for (int l = 0; l < Height; ++l)
+					{
+						GetRow(Slice, Key, j + l) &= ~RunMask;
+					}
+
+					FBlockData CurrentMask;
+					CurrentMask.Mask = FMask{ LocalTypes[Key / 2], Key % 2 == 0 ? 1 : -1 };
+
+					// Route water faces to the liquid mesh and everything else to the land mesh
+					const bool isWaterBlock = BlockRegistry::Get(CurrentMask.Mask.BlockType).bIsLiquid;
+
+					ChunkItr[Axis1] = i;
+					ChunkItr[Axis2] = j;
+					DeltaAxis1[Axis1] = Width;
+					DeltaAxis2[Axis2] = Height;
+
+					CreateQuad(
+						CurrentMask,
+						AxisMask,
+						Width,
+						Height,
+						ChunkItr,
+						ChunkItr + DeltaAxis1,
+						ChunkItr + DeltaAxis2,
+						ChunkItr + DeltaAxis1 + DeltaAxis2,
+						isWaterBlock ? Section.LiquidMeshData : Section.LandMeshData,
+						isWaterBlock ? Section.LiquidVertexCount : Section.LandVertexCount
+					);
+
+					DeltaAxis1 = FIntVector::ZeroValue;
+					DeltaAxis2 = FIntVector::ZeroValue;
+				}
+			}
+		}
+	}
+}
+
+void FChunkData::ClearMesh(bool isLandMesh)
+{
+	for (FChunkMeshSection& Section : MeshSections)
+	{
+		FChunkMeshData& MeshData = isLandMesh ? Section.LandMeshData : Section.LiquidMeshData;
+		int& VertexCount = isLandMesh ? Section.LandVertexCount : Section.LiquidVertexCount;
+
+		VertexCount = 0;
+		MeshData.Clear();
+	}
+}
+
+bool FChunkData::CompareMask(const FMask M1, const FMask M2) const
+{
+	return M1.BlockType == M2.BlockType && M1.Normal == M2.Normal;
+}
+
+void FChunkData::GenerateTrees(const TArray<FIntVector>& LocalTreePositions)
+{
+	// Defaults
+	int DefaultTreeHeight = 5;
+	EBlock DefaultLog = EBlock::Log;
+	EBlock DefaultLeaves = EBlock::Leaves;
+
+	// Voxels past the chunk bounds are kept for the neighbour they fall in, which places them when it generates
+	auto PlaceTreeBlock = [this](const FIntVector& Position, const EBlock Block)
+	{
+		if (IsInsideChunk(Position))
+		{
+			Blocks.Set(GetBlockIndex(Position.X, Position.Y, Position.Z), Block);
+			return;
+		}
+
+		const FIntVector Offset(
+			FMath::FloorToInt(Position.X / static_cast<float>(ChunkSize)),
+			FMath::FloorToInt(Position.Y / static_cast<float>(ChunkSize)),
+			FMath::FloorToInt(Position.Z / static_cast<float>(ChunkSize)));
+		OverflowFeatureBlocks.FindOrAdd(ChunkPosition + Offset).Add(FFeatureBlock { Position - Offset * ChunkSize, Block });
+	};
+
+	for (const FIntVector& Position : LocalTreePositions)
+	{
+		int X = Position.X;
+		int Y = Position.Y;
+		int Z = Position.Z;
+
+		EBiome CurrentBiome = GetColumnBiome(X, Y);
+
+		int TreeHeight = DefaultTreeHeight;
+		EBlock Log = DefaultLog;
+		EBlock Leaves = DefaultLeaves;
+
+
+		switch (CurrentBiome)
+		{
+		case EBiome::Null:
+			break;
+		case EBiome::Desert:
+			break;
+		case EBiome::Swamp:
+			TreeHeight = 7;
+			Log = EBlock::Log;
+			Leaves = EBlock::Leaves;
+			break;
+		case EBiome::Tundra:
+			break;
+		case EBiome::Taiga:
+			TreeHeight = 10;
+			Log = EBlock::Log;
+			Leaves = EBlock::Leaves;
+			break;
+		case EBiome::Plains:
+			break;
+		default:
+			break;
+		}
+
+
+		/********************************** Generating Trees **********************************************/
+		// Place the trunk
+		for (int i = 0; i < TreeHeight; ++i)
+		{
+			PlaceTreeBlock(FIntVector(X, Y, Z + i), EBlock::Log);
+		}
+
+		// Place the leaves
+
+		// Adjust the radius of the leaf canopy
+		int LeafRadius = 2;
+
+		// Start leaves from just below the top of the trunk
+		for (int dz = TreeHeight - 1; dz <= TreeHeight + LeafRadius; ++dz)
+		{
+			// Randomize X and Y placement within the leaf radius
+			for (int dx = -LeafRadius; dx <= LeafRadius; ++dx)
+			{
+				for (int dy = -LeafRadius; dy <= LeafRadius; ++dy)
+				{
+					// Ensure leaf placement forms a circular shape
+					if (FMath::Abs(dx) + FMath::Abs(dy) <= LeafRadius)
+					{
+						PlaceTreeBlock(FIntVector(X + dx, Y + dy, Z + dz), EBlock::Leaves);
+					}
+				}
+			}
+		}
+
+	}
+}
+
+void FChunkData::GenerateDecorations()
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelDecoration);
+
+	// Stamp every tree collected during biome assignment in one pass
+	GenerateTrees(TreePositions);
+	TreePositions.Reset();
+
+	// Trees of neighbours that generated before this chunk was queued
+	ApplyFeatureBlocks(IncomingFeatureBlocks);
+	IncomingFeatureBlocks.Reset();
+
+	// Drop flora whose spot was taken by a trunk or canopy
+	FloraPositions.RemoveAll([this](const FDecorationData& Decoration)
+	{
+		const FIntVector Ground = Decoration.Position - FIntVector(0, 0, 1);
+		return GetBlockType(Decoration.Position) != EBlock::Air || GetBlockType(Ground) != EBlock::Grass;
+	});
+}
+
+bool FChunkData::ApplyFeatureBlocks(const TArray<FFeatureBlock>& FeatureBlocks)
+{
+	// Saved blocks already hold the trees that reached the chunk before it was saved
+	if (bIsRestored)
+		return false;
+
+	bool bChanged = false;
+	for (const FFeatureBlock& FeatureBlock : FeatureBlocks)
+	{
+		const FIntVector& Position = FeatureBlock.Position;
+		const int32 Index = GetBlockIndex(Position.X, Position.Y, Position.Z);
+		const EBlock Current = Blocks.Get(Index);
+
+		if (Current == EBlock::Air || (Current == EBlock::Leaves && FeatureBlock.Block == EBlock::Log))
+		{
+			Blocks.Set(Index, FeatureBlock.Block);
+			MarkVoxelDirty(Position);
+			bChanged = true;
+		}
+	}
+
+	if (bChanged)
+	{
+		Contents = EChunkContents::Mixed;
+		FloraPositions.RemoveAll([this](const FDecorationData& Decoration)
+		{
+			return GetBlockType(Decoration.Position) != EBlock::Air;
+		});
+	}
+	return bChanged;
+}
+
+void FChunkData::RebuildMeshes()
+{
+	ClearMesh(true);
+	ClearMesh(false);
+
+	// Uniform chunks hold no water to spread
+	if (Contents == EChunkContents::Mixed)
+	{
+		UpdateWaterMesh();
+	}
+	GenerateMesh();
+}
+
+bool FChunkData::IsMeshEmpty(const bool isLandMesh) const
+{
+	for (const FChunkMeshSection& Section : MeshSections)
+	{
+		if ((isLandMesh ? Section.LandVertexCount : Section.LiquidVertexCount) > 0)
+			return false;
+	}
+	return true;
+}
+
+bool FChunkData::IsSectionExposed(const int32 SectionIndex) const
+{
+	const int32 MinZ = SectionIndex * SectionHeight;
+	const int32 MaxZ = FMath::Min(MinZ + SectionHeight, ChunkSize);
+
+	for (int32 Face = 0; Face < 6; ++Face)
+	{
+		// The top and bottom halo only touch the outermost sections
+		const int32 Axis = Face % 3;
+		if (Axis == 2 && SectionIndex != (Face < 3 ? MeshSections.Num() - 1 : 0))
+			continue;
+
+		FIntVector Position = FIntVector::ZeroValue;
+		for (Position[(Axis + 2) % 3] = 0; Position[(Axis + 2) % 3] < ChunkSize; ++Position[(Axis + 2) % 3])
+		{
+			for (Position[(Axis + 1) % 3] = 0; Position[(Axis + 1) % 3] < ChunkSize; ++Position[(Axis + 1) % 3])
+			{
+				if (Axis != 2 && (Position.Z < MinZ || Position.Z >= MaxZ))
+					continue;
+
+				if (!BlockRegistry::Get(Halo[Face][GetHaloIndex(Axis, Position)]).bIsOpaque)
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+uint32 FChunkData::RebuildDirtySections()
+{
+	const uint32 RebuiltMask = DirtySectionMask;
+	for (int32 SectionIndex = 0; SectionIndex < MeshSections.Num(); ++SectionIndex)
+	{
+		if (RebuiltMask & (1u << SectionIndex))
+		{
+			GenerateSectionMesh(SectionIndex);
+		}
+	}
+	DirtySectionMask = 0;
+	return RebuiltMask;
+}
+
+void FChunkData::UpdateWaterAround(const FIntVector& Position, TArray<FIntVector>& OutFlooded)
+{
+	// Same spreading rule as UpdateWaterMesh, but only from the edited voxel outwards
+	auto ForEachNeighbour = [this](const FIntVector& Center, auto&& Visit)
+	{
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dz = -1; dz <= 1; ++dz)
+				{
+					const FIntVector Neighbour = Center + FIntVector(dx, dy, dz);
+					if ((dx != 0 || dy != 0 || dz != 0) && IsInsideChunk(Neighbour))
+					{
+						Visit(Neighbour);
+					}
+				}
+			}
+		}
+	};
+
+	// An air pocket opened next to water fills up first
+	const int32 LocalWaterLevel = GetLocalWaterLevel();
+	if (GetBlockType(Position) == EBlock::Air && Position.Z + 1 <= LocalWaterLevel)
+	{
+		EBlock Liquid = EBlock::Null;
+		ForEachNeighbour(Position, [&](const FIntVector& Neighbour)
+		{
+			const EBlock NeighbourBlock = GetBlockType(Neighbour);
+			if (BlockRegistry::Get(NeighbourBlock).bIsLiquid)
+			{
+				Liquid = NeighbourBlock;
+			}
+		});
+
+		if (Liquid != EBlock::Null)
+		{
+			Blocks.Set(GetBlockIndex(Position.X, Position.Y, Position.Z), Liquid);
+			MarkVoxelDirty(Position);
+			OutFlooded.Add(Position);
+		}
+	}
+
+	if (!BlockRegistry::Get(GetBlockType(Position)).bIsLiquid)
+		return;
+
+	TArray<FIntVector, TInlineAllocator<64>> Pending;
+	Pending.Add(Position);
+
+	while (Pending.Num() > 0)
+	{
+		const FIntVector Current = Pending.Pop(false);
+		const EBlock Liquid = GetBlockType(Current);
+
+		ForEachNeighbour(Current, [&](const FIntVector& Neighbour)
+		{
+			if (GetBlockType(Neighbour) == EBlock::Air && Neighbour.Z + 1 <= LocalWaterLevel)
+			{
+				Blocks.Set(GetBlockIndex(Neighbour.X, Neighbour.Y, Neighbour.Z), Liquid);
+				MarkVoxelDirty(Neighbour);
+				OutFlooded.Add(Neighbour);
+				Pending.Add(Neighbour);
+			}
+		});
+	}
+}
+
+void FChunkData::UpdateWaterMesh()
+{
+	const int32 LocalWaterLevel = GetLocalWaterLevel();
+
+	for (int x = 0; x < ChunkSize; ++x)
+	{
+		for (int y = 0; y < ChunkSize; ++y)
+		{
+			for (int z = 0; z < ChunkSize; ++z)
+			{
+				const auto BlockType = Blocks.Get(GetBlockIndex(x, y, z));
+
+				if (BlockRegistry::Get(BlockType).bIsLiquid)
+				{
+					// Check surrounding blocks
+					for (int dx = -1; dx <= 1; ++dx)
+					{
+						for (int dy = -1; dy <= 1; ++dy)
+						{
+							for (int dz = -1; dz <= 1; ++dz)
+							{
+								if (dx == 0 && dy == 0 && dz == 0)
+									continue;
+
+								int nx = x + dx;
+								int ny = y + dy;
+								int nz = z + dz;
+
+								if (nx >= 0 && ny >= 0 && nz >= 0 && nx < ChunkSize && ny < ChunkSize && nz < ChunkSize)
+								{
+									const int NeighborIndex = GetBlockIndex(nx, ny, nz);
+									auto NeighborBlockType = Blocks.Get(NeighborIndex);
+
+									if (NeighborBlockType == EBlock::Air && (nz + 1) <= LocalWaterLevel)
+									{
+										// Convert air pocket to water
+										Blocks.Set(NeighborIndex, BlockType);
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
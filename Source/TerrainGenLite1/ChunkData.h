@@ -0,0 +1,237 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeLock.h"
+#include "Enums.h"
+#include "BlockData.h"
+#include "ChunkMeshData.h"
+#include "FeatureHash.h"
+#include "PalettedBlockStorage.h"
+#include "WaterSourceIndex.h"
+
+// Time spent in each generation stage for one chunk, in seconds
+struct FChunkGenerationTimings
+{
+	double Density = 0.0;
+	double Biome = 0.0;
+	double Decoration = 0.0;
+	double Meshing = 0.0;
+};
+
+// Land and liquid mesh of one horizontal slab of a chunk, uploaded as its own mesh section
+struct FChunkMeshSection
+{
+	FChunkMeshData LandMeshData;
+	FChunkMeshData LiquidMeshData;
+	int LandVertexCount = 0;
+	int LiquidVertexCount = 0;
+
+	// Voxel faces on the chunk border emitted by the last land mesh, and the ones the halo hid
+	int32 BorderFaceCount = 0;
+	int32 CulledBorderFaceCount = 0;
+
+	void Clear();
+};
+
+// Height map of one column of stacked chunks, computed once and shared by every chunk in it
+struct FChunkColumnSurface
+{
+	// World height, in blocks, of the first air block above the ground, indexed by FChunkData::GetColumnIndex
+	TArray<int32> Heights;
+	int32 MinHeight = 0;
+	int32 MaxHeight = 0;
+};
+
+// Column of stacked chunks, handed by AChunkWorld to every chunk in it. The first chunk of the column
+// to reach the density stage computes the surface on its worker, the others reuse it
+class FChunkColumn
+{
+public:
+	// Calls Generate on the first call only, later calls from any thread wait for it and return the same surface
+	template <typename FunctorType>
+	TSharedRef<const FChunkColumnSurface> GetSurface(FunctorType&& Generate)
+	{
+		FScopeLock Lock(&CriticalSection);
+		if (!Surface.IsValid())
+		{
+			Surface = Generate();
+		}
+		return Surface.ToSharedRef();
+	}
+
+private:
+	FCriticalSection CriticalSection;
+	TSharedPtr<const FChunkColumnSurface> Surface;
+};
+
+/**
+ * Plain-data voxel and mesh buffers for a single chunk.
+ *
+ * Holds no UObject references so the generation stages can run on worker threads. A buffer is
+ * owned by one thread at a time: the generation pipeline while the chunk is queued, then the
+ * game thread once the chunk has been handed back for its mesh upload.
+ */
+class FChunkData
+{
+public:
+	FChunkData(const FIntVector& InChunkPosition, int32 InChunkSize, int32 InWaterLevel);
+
+	// Chunk coordinate, in chunks
+	FIntVector ChunkPosition;
+	const int32 ChunkSize;
+
+	// World height in blocks, see GetLocalWaterLevel for this chunk's layers
+	const int32 WaterLevel;
+
+	// Set by AChunkWorld before the chunk is queued, its surface is computed on the generation workers
+	TSharedPtr<FChunkColumn> Column;
+
+	// Palette-compressed block ids, indexed by GetBlockIndex
+	TPalettedBlockStorage<EBlock> Blocks;
+
+	// Biome and humidity per column, indexed by GetColumnIndex
+	TArray<EBiome> BiomeMap;
+	TArray<float> HumidityMap;
+
+	TArray<FIntVector> WaterBlockPositions;
+
+	// Built with the meshes, registered with AChunkWorld's water source index while the chunk is loaded
+	FChunkWaterSources WaterSources;
+	TArray<FIntVector> TreePositions;
+	TArray<FDecorationData> FloraPositions;
+
+	// Tree voxels past the chunk bounds keyed by the chunk coordinate they fall in, filled by
+	// GenerateTrees and handed to AChunkWorld when the chunk is uploaded
+	TMap<FIntVector, TArray<FFeatureBlock>> OverflowFeatureBlocks;
+
+	// Voxels of neighbouring trees that reach into this chunk, set by AChunkWorld before the chunk is
+	// queued and placed by GenerateDecorations after the chunk's own trees
+	TArray<FFeatureBlock> IncomingFeatureBlocks;
+
+	// Chunks whose overflowing trees were handed to this one, a neighbour that unloads and generates
+	// again does not regrow leaves that were dug out since
+	TSet<FIntVector> FeatureSources;
+
+	// Height in voxels of a mesh section; a voxel edit only remeshes the sections it touches
+	static constexpr int32 SectionHeight = 8;
+
+	// Mesh sections from the bottom of the chunk up
+	TArray<FChunkMeshSection> MeshSections;
+
+	// Sections whose blocks or halo changed since they were last meshed, bit per section index
+	uint32 DirtySectionMask = 0;
+
+	FChunkGenerationTimings Timings;
+
+	// Set by generation so the later stages can skip uniform chunks, voxel edits turn it back to Mixed
+	EChunkContents Contents = EChunkContents::Mixed;
+
+	// The blocks and flora were read from a region file, generation only rebuilds the biome maps and meshes
+	bool bIsRestored = false;
+
+	// Set by SetBlock, cleared once the chunk is written to its region file
+	bool bHasUnsavedEdits = false;
+
+	EChunkMesher Mesher = EChunkMesher::BinaryGreedy;
+
+	// One-voxel padding copied from the six face neighbours, indexed like BlockRegistry faces.
+	// Filled by AChunkWorld on the game thread, Air where the neighbour is not loaded.
+	TArray<EBlock> Halo[6];
+	uint8 HaloFaceMask = 0;
+
+	// Prepares the buffers for another chunk coordinate, keeping their allocations
+	void Reset(const FIntVector& InChunkPosition);
+
+	// Classifies the blocks into Contents, only a compacted single entry palette counts as uniform
+	void UpdateContents();
+
+	// Writes a voxel after generation; the first edit of a uniform chunk allocates its per voxel storage
+	void SetBlock(const FIntVector& Position, EBlock Block);
+
+	// Local Z below which air floods, negative for chunks above the water and past ChunkSize below it
+	int32 GetLocalWaterLevel() const { return WaterLevel - ChunkPosition.Z * ChunkSize; }
+
+	int GetBlockIndex(int X, int Y, int Z) const;
+	int GetColumnIndex(int X, int Y) const;
+	bool IsInsideChunk(const FIntVector& Index) const;
+
+	// Returns Air for positions outside the chunk
+	EBlock GetBlockType(const FIntVector& Index) const;
+
+	// Also reads the halo one voxel past each face; edges and corners outside the chunk are Air
+	EBlock GetPaddedBlockType(const FIntVector& Index) const;
+
+	// Copies the border layer of the neighbour across the given face into the halo
+	void CopyHaloFace(int32 Face, const FChunkData& Neighbour);
+	void ClearHaloFace(int32 Face);
+
+	// Copies the border layer like CopyHaloFace but only marks the sections whose halo changed.
+	// Returns false if the halo was already up to date
+	bool RefreshHaloFace(int32 Face, const FChunkData& Neighbour);
+	bool HasHaloFace(int32 Face) const { return (HaloFaceMask & (1 << Face)) != 0; }
+	EBiome GetColumnBiome(int32 X, int32 Y) const;
+	float GetColumnHumidity(int32 X, int32 Y) const;
+
+	// Stores the biome information for a column and applies it to every block in it. Trees and flora
+	// are placed by hashing WorldSeed with the world position of each block
+	void SetColumnBiome(int32 X, int32 Y, EBiome BiomeType, float Humidity, int32 WorldSeed);
+
+	// Places the trees and flora collected by ApplyBiome, once per chunk after biome assignment
+	void GenerateDecorations();
+	void GenerateTrees(const TArray<FIntVector>& LocalTreePositions);
+
+	// Places neighbouring tree voxels into air, and trunks into leaves, so overlapping trees come out
+	// the same whichever chunk generated first. Marks the touched sections dirty without flagging an
+	// edit, and returns false if nothing changed. Restored chunks are left as they were saved
+	bool ApplyFeatureBlocks(const TArray<FFeatureBlock>& FeatureBlocks);
+
+	int32 GetNumSections() const { return MeshSections.Num(); }
+
+	// True if no section of the land or liquid mesh has a vertex
+	bool IsMeshEmpty(bool isLandMesh) const;
+	int32 GetSectionIndex(int32 Z) const { return Z / SectionHeight; }
+
+	// Summed over all sections
+	int32 GetBorderFaceCount() const;
+	int32 GetCulledBorderFaceCount() const;
+
+	// Marks the section holding the voxel dirty, and the one across a section boundary it touches
+	void MarkVoxelDirty(const FIntVector& Position);
+	void MarkAllSectionsDirty();
+
+	// Clears and regenerates both the land and the liquid mesh buffers from the current blocks
+	void RebuildMeshes();
+
+	// Remeshes only the dirty sections and returns the mask of the sections that were rebuilt
+	uint32 RebuildDirtySections();
+
+	// Single meshing pass per section, routes water faces to LiquidMeshData and all other faces to LandMeshData
+	void GenerateMesh();
+	void GenerateSectionMesh(int32 SectionIndex);
+	void ClearMesh(bool isLandMesh);
+	void UpdateWaterMesh();
+
+	// Floods the air below the water level reachable from the water around Position, marking the
+	// changed sections dirty and adding the flooded voxels to OutFlooded. Local counterpart of
+	// UpdateWaterMesh for single voxel edits
+	void UpdateWaterAround(const FIntVector& Position, TArray<FIntVector>& OutFlooded);
+
+private:
+	// Converts the block at (X, Y, Z) for its biome and records tree and flora candidates
+	void ApplyBiome(int32 X, int32 Y, int32 Z, EBiome BiomeType, int32 WorldSeed);
+
+	// Cell by cell greedy mesher for the voxels with MinZ <= Z < MaxZ
+	void GenerateGreedyMesh(FChunkMeshSection& Section, int32 MinZ, int32 MaxZ);
+
+	// Builds the same quads as the cell by cell mesher from per-column bitmasks, needs ChunkSize <= 62
+	void GenerateBinaryGreedyMesh(FChunkMeshSection& Section, int32 MinZ, int32 MaxZ);
+
+	// True if a halo voxel next to the section does not hide the faces of a Solid chunk
+	bool IsSectionExposed(int32 SectionIndex) const;
+
+	void CreateQuad(const FBlockData BlockData, const FIntVector AxisMask, int Width, int Height, const FIntVector V1, const FIntVector V2, const FIntVector V3, const FIntVector V4, FChunkMeshData& MeshData, int& VertexCount);
+
+	bool CompareMask(FMask M1, FMask M2) const;
+
+	int GetHaloIndex(int32 Axis, const FIntVector& Index) const;
+};
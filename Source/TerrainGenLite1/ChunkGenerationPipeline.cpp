@@ -0,0 +1,127 @@
+#include "ChunkGenerationPipeline.h"
+
+#include "ChunkData.h"
+#include "ChunkGenerator.h"
+#include "ChunkRegionStore.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/QueuedThreadPool.h"
+
+// A single stage of a single chunk, queued on the generation thread pool
+class FChunkGenerationPipeline::FStageWork final : public IQueuedWork
+{
+public:
+	FStageWork(FChunkGenerationPipeline& InPipeline, const EChunkGenerationStage InStage, const TSharedRef<FChunkData>& InChunk)
+		: Pipeline(InPipeline),
+		Stage(InStage),
+		Chunk(InChunk)
+	{
+	}
+
+	virtual void DoThreadedWork() override
+	{
+		Pipeline.RunStage(Stage, Chunk);
+		delete this;
+	}
+
+	virtual void Abandon() override
+	{
+		Pipeline.StageDepths[static_cast<int32>(Stage)].Decrement();
+		delete this;
+	}
+
+private:
+	FChunkGenerationPipeline& Pipeline;
+	const EChunkGenerationStage Stage;
+	TSharedRef<FChunkData> Chunk;
+};
+
+FChunkGenerationPipeline::FChunkGenerationPipeline(const TSharedRef<const FChunkGenerator>& InGenerator, const int32 InNumWorkers, FChunkRegionStore* InRegionStore)
+	: Generator(InGenerator),
+	RegionStore(InRegionStore)
+{
+	NumWorkers = InNumWorkers > 0 ? InNumWorkers : FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 2);
+
+	ThreadPool = FQueuedThreadPool::Allocate();
+	verify(ThreadPool->Create(NumWorkers, 256 * 1024, TPri_BelowNormal, TEXT("ChunkGenerationPool")));
+
+	UE_LOG(LogTemp, Log, TEXT("Chunk generation pipeline started with %d workers"), NumWorkers);
+}
+
+FChunkGenerationPipeline::~FChunkGenerationPipeline()
+{
+	ThreadPool->Destroy();
+	delete ThreadPool;
+}
+
+void FChunkGenerationPipeline::Enqueue(const TSharedRef<FChunkData>& Chunk)
+{
+	Dispatch(EChunkGenerationStage::Density, Chunk);
+}
+
+bool FChunkGenerationPipeline::DequeueCompleted(TSharedPtr<FChunkData>& OutChunk)
+{
+	if (!CompletedChunks.Dequeue(OutChunk))
+	{
+		return false;
+	}
+
+	StageDepths[static_cast<int32>(EChunkGenerationStage::Upload)].Decrement();
+	return true;
+}
+
+int32 FChunkGenerationPipeline::GetQueueDepth(const EChunkGenerationStage Stage) const
+{
+	return StageDepths[static_cast<int32>(Stage)].GetValue();
+}
+
+void FChunkGenerationPipeline::Dispatch(const EChunkGenerationStage Stage, const TSharedRef<FChunkData>& Chunk)
+{
+	StageDepths[static_cast<int32>(Stage)].Increment();
+
+	if (Stage == EChunkGenerationStage::Upload)
+	{
+		CompletedChunks.Enqueue(Chunk);
+		return;
+	}
+
+	ThreadPool->AddQueuedWork(new FStageWork(*this, Stage, Chunk));
+}
+
+void FChunkGenerationPipeline::RunStage(const EChunkGenerationStage Stage, const TSharedRef<FChunkData>& Chunk)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	switch (Stage)
+	{
+	case EChunkGenerationStage::Density:
+		// A saved chunk skips density generation and keeps its edits
+		if (RegionStore)
+		{
+			RegionStore->LoadChunk(*Chunk);
+		}
+		Generator->GenerateDensity(*Chunk);
+		Chunk->Timings.Density = FPlatformTime::Seconds() - StartTime;
+		break;
+	case EChunkGenerationStage::Biome:
+		Generator->AssignBiomes(*Chunk);
+		Chunk->Timings.Biome = FPlatformTime::Seconds() - StartTime;
+		break;
+	case EChunkGenerationStage::Decoration:
+		Generator->Decorate(*Chunk);
+		Chunk->Timings.Decoration = FPlatformTime::Seconds() - StartTime;
+		break;
+	case EChunkGenerationStage::Meshing:
+		Generator->GenerateMeshes(*Chunk);
+		Chunk->Timings.Meshing = FPlatformTime::Seconds() - StartTime;
+		break;
+	default:
+		checkNoEntry();
+		break;
+	}
+
+	StageDepths[static_cast<int32>(Stage)].Decrement();
+
+	// Stages are declared in pipeline order, ending with the game thread upload
+	Dispatch(static_cast<EChunkGenerationStage>(static_cast<int32>(Stage) + 1), Chunk);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums.h"
+#include "Containers/Queue.h"
+#include "HAL/ThreadSafeCounter.h"
+
+class FChunkData;
+class FChunkGenerator;
+class FChunkRegionStore;
+class FQueuedThreadPool;
+
+/**
+ * Runs chunk generation on a dedicated pool of worker threads.
+ *
+ * Every chunk goes through the Density, Biome, Decoration and Meshing stages, each queued as its
+ * own task on the pool, and finishes in a completion queue the game thread drains to upload the
+ * mesh sections. Only the upload touches UObjects, everything before it works on FChunkData.
+ * Chunks with a save in the region store are restored by the Density stage instead of generated.
+ */
+class FChunkGenerationPipeline
+{
+public:
+	// NumWorkers <= 0 uses the logical core count minus two, at least one, leaving room for the game and render threads.
+	// The region store is optional and must outlive the pipeline
+	FChunkGenerationPipeline(const TSharedRef<const FChunkGenerator>& InGenerator, int32 NumWorkers, FChunkRegionStore* InRegionStore = nullptr);
+
+	// Abandons queued stages and waits for the running ones to finish
+	~FChunkGenerationPipeline();
+
+	// Hands the chunk over to the worker threads until it comes back through DequeueCompleted
+	void Enqueue(const TSharedRef<FChunkData>& Chunk);
+
+	// Game thread only: returns the next chunk whose meshes are ready for upload
+	bool DequeueCompleted(TSharedPtr<FChunkData>& OutChunk);
+
+	// Number of chunks waiting for or running the given stage
+	int32 GetQueueDepth(EChunkGenerationStage Stage) const;
+
+	int32 GetNumWorkers() const { return NumWorkers; }
+
+	const FChunkGenerator& GetGenerator() const { return *Generator; }
+
+private:
+	class FStageWork;
+
+	void Dispatch(EChunkGenerationStage Stage, const TSharedRef<FChunkData>& Chunk);
+	void RunStage(EChunkGenerationStage Stage, const TSharedRef<FChunkData>& Chunk);
+
+	TSharedRef<const FChunkGenerator> Generator;
+	FChunkRegionStore* RegionStore = nullptr;
+	FQueuedThreadPool* ThreadPool = nullptr;
+	int32 NumWorkers = 0;
+
+	TQueue<TSharedPtr<FChunkData>, EQueueMode::Mpsc> CompletedChunks;
+	FThreadSafeCounter StageDepths[static_cast<int32>(EChunkGenerationStage::Num)];
+};
@@ -0,0 +1,521 @@
+#include "ChunkGenerator.h"
+
+#include "ChunkData.h"
+#include "NoiseBatch.h"
+#include "VoxelStats.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Chunk Density"), STAT_VoxelDensity, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Biome Assignment"), STAT_VoxelBiomeAssignment, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Chunk Meshing"), STAT_VoxelMeshing, STATGROUP_Voxel);
+
+FChunkGenerator::FChunkGenerator(const int32 InWorldSeed, const float InFrequency, const ECaveSampling InCaveSampling, const int32 InCaveLatticeStep,
+	const int32 InWorldHeight, const int32 InTerrainHeight, const int32 InCaveDepth)
+	: WorldSeed(InWorldSeed),
+	Frequency(InFrequency),
+	CaveSampling(InCaveSampling),
+	CaveLatticeStep(FMath::Max(InCaveLatticeStep, 1)),
+	WorldHeight(FMath::Max(InWorldHeight, 1)),
+	TerrainHeight(FMath::Max(InTerrainHeight, 0)),
+	CaveDepth(FMath::Max(InCaveDepth, 0))
+{
+	TerrainNoise.SetSeed(WorldSeed);
+	TerrainNoise.SetFrequency(Frequency);
+	TerrainNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+	TerrainNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
+
+	BiomeNoise.SetSeed(WorldSeed);
+	BiomeNoise.SetFrequency(0.010); // Lower frequency for smoother transitions
+	BiomeNoise.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
+	BiomeNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
+	BiomeNoise.SetFractalOctaves(3); // More octaves for detail
+	BiomeNoise.SetCellularReturnType(FastNoiseLite::CellularReturnType_CellValue);
+
+	HumidityNoise.SetSeed(WorldSeed);
+	HumidityNoise.SetFrequency(0.005); // Matching frequency for aligned transitions
+	HumidityNoise.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
+	HumidityNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
+	HumidityNoise.SetFractalOctaves(3);
+	HumidityNoise.SetCellularReturnType(FastNoiseLite::CellularReturnType_CellValue);
+	HumidityNoise.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Hybrid);
+	HumidityNoise.SetCellularJitter(2.5f);
+}
+
+TSharedRef<const FChunkColumnSurface> FChunkGenerator::GenerateColumnSurface(const FIntPoint& Column, const int32 ChunkSize) const
+{
+	TSharedRef<FChunkColumnSurface> Surface = MakeShared<FChunkColumnSurface>();
+
+	TArray<float> HeightNoise;
+	HeightNoise.SetNumUninitialized(ChunkSize * ChunkSize);
+	FNoiseBatch::GenerateGrid2D(TerrainNoise, HeightNoise.GetData(), ChunkSize, ChunkSize, float(Column.X * ChunkSize), float(Column.Y * ChunkSize));
+
+	Surface->Heights.SetNumUninitialized(ChunkSize * ChunkSize);
+	Surface->MinHeight = WorldHeight;
+	Surface->MaxHeight = 0;
+	for (int32 i = 0; i < HeightNoise.Num(); ++i)
+	{
+		const int32 Height = FMath::Clamp(FMath::RoundToInt((HeightNoise[i] + 1) * TerrainHeight / 2), 0, WorldHeight);
+		Surface->Heights[i] = Height;
+		Surface->MinHeight = FMath::Min(Surface->MinHeight, Height);
+		Surface->MaxHeight = FMath::Max(Surface->MaxHeight, Height);
+	}
+
+	return Surface;
+}
+
+EChunkContents FChunkGenerator::ClassifyChunk(const FChunkColumnSurface& Surface, const int32 ChunkZ, const int32 ChunkSize, const int32 WaterLevel) const
+{
+	const int32 Bottom = ChunkZ * ChunkSize;
+	const int32 Top = Bottom + ChunkSize;
+
+	// The bottom layer holds the bedrock
+	if (Bottom <= 0)
+	{
+		return EChunkContents::Mixed;
+	}
+
+	// Above every column's surface and above the water only air is generated
+	if (Bottom >= Surface.MaxHeight && Bottom >= WaterLevel)
+	{
+		return EChunkContents::Empty;
+	}
+
+	// Below the dirt layer and the deepest cave of every column only stone
+	if (Top <= Surface.MinHeight - FMath::Max(CaveDepth, 3))
+	{
+		return EChunkContents::Solid;
+	}
+
+	return EChunkContents::Mixed;
+}
+
+void FChunkGenerator::GenerateDensity(FChunkData& Chunk) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelDensity);
+
+	// The saved blocks already hold the terrain and every edit made to it
+	if (Chunk.bIsRestored)
+	{
+		Chunk.UpdateContents();
+		return;
+	}
+
+	const int ChunkSize = Chunk.ChunkSize;
+	const int WaterLevel = Chunk.WaterLevel;
+	const FVector Position = FVector(Chunk.ChunkPosition * ChunkSize);
+
+	// Chunks generated outside AChunkWorld have no shared column
+	const FIntPoint Column(Chunk.ChunkPosition.X, Chunk.ChunkPosition.Y);
+	const TSharedRef<const FChunkColumnSurface> Surface = Chunk.Column.IsValid()
+		? Chunk.Column->GetSurface([this, &Column, ChunkSize] { return GenerateColumnSurface(Column, ChunkSize); })
+		: GenerateColumnSurface(Column, ChunkSize);
+	const TArray<int32>& SurfaceHeights = Surface->Heights;
+
+	const EChunkContents Contents = ClassifyChunk(*Surface, Chunk.ChunkPosition.Z, ChunkSize, WaterLevel);
+	if (Contents != EChunkContents::Mixed)
+	{
+		Chunk.Blocks.Fill(Contents == EChunkContents::Empty ? EBlock::Air : EBlock::Stone);
+		Chunk.UpdateContents();
+		return;
+	}
+
+	// Caves only carve 7 blocks or more below the surface, the 3D noise is not needed above the highest of them
+	int32 NumCaveLayers = 0;
+	for (const int32 SurfaceHeight : SurfaceHeights)
+	{
+		NumCaveLayers = FMath::Max(NumCaveLayers, SurfaceHeight - 7 - Chunk.ChunkPosition.Z * ChunkSize + 1);
+	}
+	NumCaveLayers = FMath::Min(NumCaveLayers, ChunkSize);
+
+	// The cave noise of the layers that can hold caves is sampled up front in SIMD batches
+	TArray<float> CaveNoise;
+	SampleCaveNoise(Position, ChunkSize, NumCaveLayers, CaveNoise);
+
+	// Tracked while filling so a chunk of a single block drops its index words right away
+	EBlock UniformBlock = EBlock::Null;
+	bool bIsUniform = true;
+
+	for (int x = 0; x < ChunkSize; ++x)
+	{
+		for (int y = 0; y < ChunkSize; ++y)
+		{
+			const float SurfaceHeight = SurfaceHeights[y * ChunkSize + x];
+
+			for (int z = 0; z < ChunkSize; ++z)
+			{
+				const double Zpos = z + Position.Z;
+
+				const int Index = Chunk.GetBlockIndex(x, y, z);
+				EBlock Block;
+
+				if (Zpos == 0)
+				{
+					Block = EBlock::Bedrock;
+				}
+				else if (Zpos <= SurfaceHeight - 7 && Zpos >= SurfaceHeight - CaveDepth && CaveNoise[Index] >= 0)
+				{
+					Block = EBlock::Air;
+				}
+				else
+				{
+					if (Zpos < SurfaceHeight - 3)
+					{
+						Block = EBlock::Stone;
+					}
+					else if (Zpos < SurfaceHeight - 1)
+					{
+						Block = EBlock::DryDirt;
+
+					}
+					else if (Zpos == SurfaceHeight - 1)
+					{
+						Block = EBlock::Grass;
+					}
+					else
+					{
+						Block = EBlock::Air;
+					}
+					if (Zpos < WaterLevel)
+					{
+						// Check if the block is air and within certain Z range
+						if (Block == EBlock::Air)
+						{
+							if (Zpos >= WaterLevel - 5)
+							{
+								Block = EBlock::ShallowWater;
+							}
+							else
+							{
+								Block = EBlock::DeepWater;
+							}
+
+							Chunk.WaterBlockPositions.Add(FIntVector(x, y, z));
+						}
+						if (Block == EBlock::Grass || Block == EBlock::DryDirt && Zpos > 10)
+						{
+							Block = EBlock::Sand;
+						}
+						else if (Block == EBlock::DryDirt || Block == EBlock::Grass)
+						{
+							Block = EBlock::Gravel;
+
+						}
+						else if (Block == EBlock::DryDirt || Block == EBlock::Grass)
+						{
+							Block = EBlock::WetDirt;
+
+						}
+					}
+				}
+
+				Chunk.Blocks.Set(Index, Block);
+
+				if (x == 0 && y == 0 && z == 0)
+				{
+					UniformBlock = Block;
+				}
+				bIsUniform &= Block == UniformBlock;
+			}
+		}
+	}
+
+	if (bIsUniform)
+	{
+		Chunk.Blocks.Fill(UniformBlock);
+	}
+	Chunk.UpdateContents();
+}
+
+void FChunkGenerator::SampleCaveNoise(const FVector& Position, const int32 ChunkSize, const int32 NumLayers, TArray<float>& OutNoise) const
+{
+	OutNoise.SetNumUninitialized(ChunkSize * ChunkSize * NumLayers);
+	if (NumLayers == 0)
+	{
+		return;
+	}
+
+	if (CaveSampling == ECaveSampling::Full || CaveLatticeStep <= 1)
+	{
+		FNoiseBatch::GenerateGrid3D(TerrainNoise, OutNoise.GetData(), ChunkSize, ChunkSize, NumLayers, float(Position.X), float(Position.Y), float(Position.Z));
+		return;
+	}
+
+	// Lattice points every Step voxels from the chunk origin, up to the first one at or past the
+	// last voxel so every cell has its far corners
+	const int32 Step = CaveLatticeStep;
+	const int32 LatticeXY = (ChunkSize - 1) / Step + 2;
+	const int32 LatticeZ = (NumLayers - 1) / Step + 2;
+
+	TArray<float> Lattice;
+	Lattice.SetNumUninitialized(LatticeXY * LatticeXY * LatticeZ);
+	FNoiseBatch::GenerateGrid3D(TerrainNoise, Lattice.GetData(), LatticeXY, LatticeXY, LatticeZ, float(Position.X), float(Position.Y), float(Position.Z), Step);
+
+	// Interpolated one axis at a time: the lattice columns along Z into a plane per layer, the
+	// plane along Y into a row, and the row along X into the voxels
+	TArray<float> Plane;
+	TArray<float> Row;
+	Plane.SetNumUninitialized(LatticeXY * LatticeXY);
+	Row.SetNumUninitialized(LatticeXY);
+	const float InvStep = 1.0f / Step;
+
+	float* Out = OutNoise.GetData();
+	for (int32 z = 0; z < NumLayers; ++z)
+	{
+		const float* Bottom = &Lattice[(z / Step) * LatticeXY * LatticeXY];
+		const float* Top = Bottom + LatticeXY * LatticeXY;
+		const float Tz = (z % Step) * InvStep;
+
+		for (int32 i = 0; i < Plane.Num(); ++i)
+		{
+			Plane[i] = FMath::Lerp(Bottom[i], Top[i], Tz);
+		}
+
+		for (int32 y = 0; y < ChunkSize; ++y)
+		{
+			const float* Front = &Plane[(y / Step) * LatticeXY];
+			const float* Back = Front + LatticeXY;
+			const float Ty = (y % Step) * InvStep;
+
+			for (int32 i = 0; i < LatticeXY; ++i)
+			{
+				Row[i] = FMath::Lerp(Front[i], Back[i], Ty);
+			}
+
+			for (int32 x = 0; x < ChunkSize; ++x)
+			{
+				*Out++ = FMath::Lerp(Row[x / Step], Row[x / Step + 1], (x % Step) * InvStep);
+			}
+		}
+	}
+}
+
+void FChunkGenerator::AssignBiomes(FChunkData& Chunk) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelBiomeAssignment);
+
+	const int ChunkSize = Chunk.ChunkSize;
+	const float X0 = Chunk.ChunkPosition.X * ChunkSize;
+	const float Y0 = Chunk.ChunkPosition.Y * ChunkSize;
+
+	// Biome and humidity only depend on the column, so sample the 2D noise once per column
+	TArray<float> BiomeValues;
+	TArray<float> HumidityValues;
+	BiomeValues.SetNumUninitialized(ChunkSize * ChunkSize);
+	HumidityValues.SetNumUninitialized(ChunkSize * ChunkSize);
+	FNoiseBatch::GenerateGrid2D(BiomeNoise, BiomeValues.GetData(), ChunkSize, ChunkSize, X0, Y0);
+	FNoiseBatch::GenerateGrid2D(HumidityNoise, HumidityValues.GetData(), ChunkSize, ChunkSize, X0, Y0);
+
+	for (int32 bx = 0; bx < ChunkSize; ++bx)
+	{
+		for (int32 by = 0; by < ChunkSize; ++by)
+		{
+			// Sample noise for biome generation
+			float NoiseValue = BiomeValues[by * ChunkSize + bx];
+			float HumidityValue = HumidityValues[by * ChunkSize + bx];
+
+			// Determine biome type based on noise values
+			EBiome BiomeType = GetBiomeType(NoiseValue, HumidityValue);
+
+			// Store the column's biome and humidity and apply them to its blocks
+			Chunk.SetColumnBiome(bx, by, BiomeType, HumidityValue, WorldSeed);
+		}
+	}
+}
+
+void FChunkGenerator::Decorate(FChunkData& Chunk) const
+{
+	// Trees and flora are stamped once the whole chunk has its biomes
+	Chunk.GenerateDecorations();
+
+	// Biome conversion leaves unused block states behind in the palette
+	Chunk.Blocks.Compact();
+	Chunk.UpdateContents();
+
+	// Runs on the workers for every chunk, kept out of the log unless asked for
+	UE_LOG(LogTemp, Verbose, TEXT("Chunk block storage: %d palette entries, %d bits per voxel, %d bytes"),
+		Chunk.Blocks.GetPaletteSize(), Chunk.Blocks.GetBitsPerIndex(), static_cast<int32>(Chunk.Blocks.GetAllocatedSize()));
+}
+
+void FChunkGenerator::GenerateMeshes(FChunkData& Chunk) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelMeshing);
+
+	Chunk.RebuildMeshes();
+
+	// After UpdateWaterMesh so the flooded air pockets count as water sources
+	Chunk.WaterSources.Build(Chunk);
+
+	int LandVertexCount = 0;
+	int LiquidVertexCount = 0;
+	SIZE_T MeshBufferSize = 0;
+	for (const FChunkMeshSection& Section : Chunk.MeshSections)
+	{
+		LandVertexCount += Section.LandVertexCount;
+		LiquidVertexCount += Section.LiquidVertexCount;
+		MeshBufferSize += Section.LandMeshData.GetAllocatedSize() + Section.LiquidMeshData.GetAllocatedSize();
+	}
+
+	// Runs on the workers for every chunk, kept out of the log unless asked for
+	UE_LOG(LogTemp, Verbose, TEXT("Chunk mesh: %d land and %d liquid vertices, %d bytes in %d sections (%d bytes per vertex)"),
+		LandVertexCount, LiquidVertexCount, static_cast<int32>(MeshBufferSize), Chunk.GetNumSections(), static_cast<int32>(sizeof(FChunkVertex)));
+}
+
+
+// Function to map noise value to EBiome enum
+// -1 Noise == Coldest, +1 Noise == Hottest
+EBiome FChunkGenerator::GetBiomeType(float NoiseValue, float Humidity) const
+{
+	// Ensure NoiseValue and Humidity are within [-1, 1]
+	NoiseValue = FMath::Clamp(NoiseValue, -1.0f, 1.0f);
+	Humidity = FMath::Clamp(Humidity, -1.0f, 1.0f);
+
+	// Adjust thresholds for smooth transitions
+	if (NoiseValue < -0.6f)
+	{
+		if (Humidity < -0.6f)
+		{
+			return EBiome::Tundra;   // Cold and dry
+		}
+		else if (Humidity < 0.4f)
+		{
+			return EBiome::Taiga;    // Cold and moderately wet
+		}
+		else
+		{
+			return EBiome::Swamp;    // Cold and wet
+		}
+	}
+	else if (NoiseValue < 0.0f)
+	{
+		if (Humidity < -0.2f)
+		{
+			return EBiome::Plains;   // Moderate and dry
+		}
+		else if (Humidity < 0.4f)
+		{
+			return EBiome::Taiga;    // Moderate and moderately wet
+		}
+		else
+		{
+			return EBiome::Swamp;    // Moderate and wet
+		}
+	}
+	else if (NoiseValue < 0.4f)
+	{
+		if (Humidity < -0.2f)
+		{
+			return EBiome::Plains;   // Warm and dry
+		}
+		else if (Humidity < 0.4f)
+		{
+			return EBiome::Swamp;    // Warm and moderately wet
+		}
+		else
+		{
+			return EBiome::Taiga;    // Warm and wet
+		}
+	}
+	else
+	{
+		if (Humidity < 0.0f)
+		{
+			return EBiome::Desert;   // Hot and dry
+		}
+		else if (Humidity < 0.4f)
+		{
+			return EBiome::Plains;   // Hot and moderately wet
+		}
+		else
+		{
+			return EBiome::Swamp;    // Hot and wet
+		}
+	}
+}
+
+void FChunkGenerator::RunCaveSamplingReport(const int32 WorldSeed, const float Frequency, const int32 ChunkSize, const int32 WaterLevel,
+	const int32 NumChunks, const int32 LatticeStep)
+{
+	// A single chunk tall world, the layer where the caves and the surface meet
+	const FChunkGenerator FullGenerator(WorldSeed, Frequency, ECaveSampling::Full, 1, ChunkSize, ChunkSize, ChunkSize);
+	const FChunkGenerator SparseGenerator(WorldSeed, Frequency, ECaveSampling::Interpolated, LatticeStep, ChunkSize, ChunkSize, ChunkSize);
+
+	// A square of chunks around the origin
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt(float(NumChunks)));
+
+	double FullSeconds = 0.0;
+	double SparseSeconds = 0.0;
+	double NoiseErrorSum = 0.0;
+	float MaxNoiseError = 0.0f;
+	int64 NumSignFlips = 0;
+	int64 NumDifferentBlocks = 0;
+	int64 NumCaveVoxels = 0;
+	const int64 NumBlocks = int64(NumChunks) * ChunkSize * ChunkSize * ChunkSize;
+
+	TArray<float> FullNoise;
+	TArray<float> SparseNoise;
+
+	for (int32 i = 0; i < NumChunks; ++i)
+	{
+		const FIntVector ChunkPosition(i % Side - Side / 2, i / Side - Side / 2, 0);
+		FChunkData FullChunk(ChunkPosition, ChunkSize, WaterLevel);
+		FChunkData SparseChunk(ChunkPosition, ChunkSize, WaterLevel);
+
+		double StartTime = FPlatformTime::Seconds();
+		FullGenerator.GenerateDensity(FullChunk);
+		FullSeconds += FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		SparseGenerator.GenerateDensity(SparseChunk);
+		SparseSeconds += FPlatformTime::Seconds() - StartTime;
+
+		for (int32 Index = 0; Index < FullChunk.Blocks.Num(); ++Index)
+		{
+			NumDifferentBlocks += FullChunk.Blocks.Get(Index) != SparseChunk.Blocks.Get(Index);
+		}
+
+		// The noise is compared only where it can carve a cave, from CaveDepth up to 7 blocks below the surface
+		const FVector Position = FVector(ChunkPosition * ChunkSize);
+		const TSharedRef<const FChunkColumnSurface> Surface = FullGenerator.GenerateColumnSurface(FIntPoint(ChunkPosition.X, ChunkPosition.Y), ChunkSize);
+		FullGenerator.SampleCaveNoise(Position, ChunkSize, ChunkSize, FullNoise);
+		SparseGenerator.SampleCaveNoise(Position, ChunkSize, ChunkSize, SparseNoise);
+		for (int32 z = 0; z < ChunkSize; ++z)
+		{
+			const int32 Zpos = z + ChunkPosition.Z * ChunkSize;
+			for (int32 y = 0; y < ChunkSize; ++y)
+			{
+				for (int32 x = 0; x < ChunkSize; ++x)
+				{
+					const int32 SurfaceHeight = Surface->Heights[y * ChunkSize + x];
+					if (Zpos == 0 || Zpos > SurfaceHeight - 7 || Zpos < SurfaceHeight - FullGenerator.CaveDepth)
+						continue;
+
+					const int32 Index = (z * ChunkSize + y) * ChunkSize + x;
+					const float Error = FMath::Abs(FullNoise[Index] - SparseNoise[Index]);
+					NoiseErrorSum += Error;
+					MaxNoiseError = FMath::Max(MaxNoiseError, Error);
+					NumSignFlips += (FullNoise[Index] >= 0) != (SparseNoise[Index] >= 0);
+					++NumCaveVoxels;
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Cave sampling report, %d chunks of %d^3 with a lattice step of %d: GenerateDensity full %.3f ms/chunk, interpolated %.3f ms/chunk (%.2fx). Over the %lld voxels caves can carve: noise error mean %.4f max %.4f, sign flipped at %.3f%%. %.3f%% of all blocks differ"),
+		NumChunks, ChunkSize, LatticeStep, FullSeconds * 1000.0 / NumChunks, SparseSeconds * 1000.0 / NumChunks, FullSeconds / FMath::Max(SparseSeconds, SMALL_NUMBER),
+		NumCaveVoxels, NoiseErrorSum / FMath::Max<int64>(NumCaveVoxels, 1), MaxNoiseError, NumSignFlips * 100.0 / FMath::Max<int64>(NumCaveVoxels, 1), NumDifferentBlocks * 100.0 / NumBlocks);
+}
+
+static FAutoConsoleCommand CaveSamplingReportCommand(
+	TEXT("Voxel.CaveSamplingReport"),
+	TEXT("Compares full and interpolated cave sampling on the same chunks. Args: [NumChunks=64] [LatticeStep=4] [WorldSeed=1337] [ChunkSize=32]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumChunks = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 64;
+		const int32 LatticeStep = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 4;
+		const int32 WorldSeed = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1337;
+		const int32 ChunkSize = Args.Num() > 3 ? FMath::Clamp(FCString::Atoi(*Args[3]), 1, int32(FChunkVertex::MaxCoordinate)) : 32;
+
+		// Same frequency and water level as the AChunkWorld and AChunkBase defaults
+		FChunkGenerator::RunCaveSamplingReport(WorldSeed, 0.03f, ChunkSize, 15, NumChunks, LatticeStep);
+	}));
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums.h"
+#include "FastNoiseLite.h"
+
+class FChunkData;
+struct FChunkColumnSurface;
+
+/**
+ * World generation rules shared by every chunk.
+ *
+ * Configured once when the world starts and read-only afterwards, so a single instance can be
+ * used by all generation worker threads at the same time (FastNoiseLite sampling is const).
+ */
+class FChunkGenerator
+{
+public:
+	FChunkGenerator(int32 InWorldSeed, float InFrequency, ECaveSampling InCaveSampling, int32 InCaveLatticeStep,
+		int32 InWorldHeight, int32 InTerrainHeight, int32 InCaveDepth);
+
+	// Surface height of every column of the chunk column at Column, in chunks. Only samples the 2D
+	// height map, so it is computed once per column and shared by the chunks stacked in it
+	TSharedRef<const FChunkColumnSurface> GenerateColumnSurface(const FIntPoint& Column, int32 ChunkSize) const;
+
+	// Empty or Solid if every block of the chunk at height ChunkZ is air or plain stone whatever the
+	// cave noise, Mixed if it needs the full density pass
+	EChunkContents ClassifyChunk(const FChunkColumnSurface& Surface, int32 ChunkZ, int32 ChunkSize, int32 WaterLevel) const;
+
+	// Fills the chunk with terrain, caves and water from the height map. Chunks ClassifyChunk
+	// finds uniform are filled without sampling any noise
+	void GenerateDensity(FChunkData& Chunk) const;
+
+	// Samples biome and humidity per column and converts the surface blocks
+	void AssignBiomes(FChunkData& Chunk) const;
+
+	// Stamps the trees and flora collected during biome assignment
+	void Decorate(FChunkData& Chunk) const;
+
+	// Builds the land and liquid mesh buffers
+	void GenerateMeshes(FChunkData& Chunk) const;
+
+	EBiome GetBiomeType(float NoiseValue, float Humidity) const;
+
+	// Generates the same chunks with full and interpolated cave sampling and logs the time of
+	// each and how many blocks differ. Bound to the "Voxel.CaveSamplingReport" console command
+	static void RunCaveSamplingReport(int32 WorldSeed, float Frequency, int32 ChunkSize, int32 WaterLevel, int32 NumChunks, int32 LatticeStep);
+
+	const int32 WorldSeed;
+	const float Frequency;
+	const ECaveSampling CaveSampling;
+	const int32 CaveLatticeStep;
+
+	// Blocks above the bottom of the world, the surface is clamped to it
+	const int32 WorldHeight;
+
+	// Surface height at the top of the height noise
+	const int32 TerrainHeight;
+
+	// Caves carve from 7 blocks below the surface down to CaveDepth below it
+	const int32 CaveDepth;
+
+private:
+	// Cave noise of the lowest NumLayers layers of the chunk, indexed like FChunkData::GetBlockIndex
+	void SampleCaveNoise(const FVector& Position, int32 ChunkSize, int32 NumLayers, TArray<float>& OutNoise) const;
+
+	FastNoiseLite TerrainNoise;
+	FastNoiseLite BiomeNoise;
+	FastNoiseLite HumidityNoise;
+};
@@ -0,0 +1,50 @@
+#include "ChunkMeshData.h"
+
+#include "ProceduralMeshComponent.h"
+
+void FChunkMeshData::Unpack(FProcMeshSection& OutSection, const float BlockSize) const
+{
+	// Resized rather than reset so a reused section keeps its capacity
+	OutSection.SectionLocalBox = FBox(ForceInit);
+	OutSection.bSectionVisible = true;
+	OutSection.ProcVertexBuffer.SetNumUninitialized(Vertices.Num(), false);
+	OutSection.ProcIndexBuffer.SetNumUninitialized(Triangles.Num(), false);
+
+	for (int32 i = 0; i < Vertices.Num(); ++i)
+	{
+		const FChunkVertex& Packed = Vertices[i];
+		const int32 Face = Packed.GetFace();
+		const int32 Axis = Face % 3;
+		const int32 Corner = Packed.GetCorner();
+		const float Width = Packed.GetWidth();
+		const float Height = Packed.GetHeight();
+
+		FVector Normal = FVector::ZeroVector;
+		Normal[Axis] = Face < 3 ? 1 : -1;
+
+		FProcMeshVertex& Vertex = OutSection.ProcVertexBuffer[i];
+		Vertex = FProcMeshVertex();
+		Vertex.Position = FVector(Packed.GetPosition()) * BlockSize;
+		Vertex.Normal = Normal;
+		Vertex.Color = FColor(0, 0, 0, Packed.GetTextureLayer());
+
+		// Corners are stored in quad order, the UVs tile the texture once per block
+		if (Axis == 0)
+		{
+			Vertex.UV0 = FVector2D((Corner & 1) ? 0 : Width, (Corner & 2) ? 0 : Height);
+		}
+		else
+		{
+			Vertex.UV0 = FVector2D((Corner & 2) ? 0 : Height, (Corner & 1) ? 0 : Width);
+		}
+
+		OutSection.SectionLocalBox += Vertex.Position;
+	}
+
+	for (int32 i = 0; i < Triangles.Num(); ++i)
+	{
+		OutSection.ProcIndexBuffer[i] = Triangles[i];
+	}
+
+	OutSection.bEnableCollision = true;
+}
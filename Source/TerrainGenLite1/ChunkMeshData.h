@@ -2,31 +2,68 @@
 
 #include "CoreMinimal.h"
 #include "Enums.h"
-#include "BlockData.h"
 #include "ChunkMeshData.generated.h"
 
+struct FProcMeshSection;
+
+/**
+ * Chunk mesh vertex packed into 64 bits.
+ *
+ * Bits 0-17 hold the chunk-local X, Y and Z corner (6 bits each), 18-20 the face index in
+ * BlockRegistry order, 21-22 the quad corner, 23-30 the texture layer and 31-42 the quad width
+ * and height used to tile the UVs. Normals, UVs and colors are rebuilt by FChunkMeshData::Unpack.
+ */
+struct FChunkVertex
+{
+	static constexpr int32 MaxCoordinate = 63;
+
+	uint64 Data = 0;
+
+	static FChunkVertex Pack(const FIntVector& Position, const int32 Face, const int32 Corner, const uint8 TextureLayer, const int32 Width, const int32 Height)
+	{
+		checkSlow(Position.X <= MaxCoordinate && Position.Y <= MaxCoordinate && Position.Z <= MaxCoordinate);
+		checkSlow(Width <= MaxCoordinate && Height <= MaxCoordinate);
+
+		FChunkVertex Vertex;
+		Vertex.Data = uint64(Position.X)
+			| uint64(Position.Y) << 6
+			| uint64(Position.Z) << 12
+			| uint64(Face) << 18
+			| uint64(Corner) << 21
+			| uint64(TextureLayer) << 23
+			| uint64(Width) << 31
+			| uint64(Height) << 37;
+		return Vertex;
+	}
+
+	FIntVector GetPosition() const { return FIntVector(Data & 63, (Data >> 6) & 63, (Data >> 12) & 63); }
+	int32 GetFace() const { return (Data >> 18) & 7; }
+	int32 GetCorner() const { return (Data >> 21) & 3; }
+	uint8 GetTextureLayer() const { return (Data >> 23) & 255; }
+	int32 GetWidth() const { return (Data >> 31) & 63; }
+	int32 GetHeight() const { return (Data >> 37) & 63; }
+};
+
 USTRUCT()
 struct FChunkMeshData
 {
 	GENERATED_BODY();
 
 public:
-	TArray<FVector> Vertices;
+	TArray<FChunkVertex> Vertices;
 	TArray<int> Triangles;
-	TArray<FVector> Normals;
-	TArray<FColor> Colors;
-	TArray<FVector2D> UV0;
-	TArray<FBlockData> BlockData;
 
 	void Clear();
+
+	// Expands the packed vertices into a procedural mesh section, positions scaled by BlockSize
+	void Unpack(FProcMeshSection& OutSection, float BlockSize) const;
+
+	SIZE_T GetAllocatedSize() const { return Vertices.GetAllocatedSize() + Triangles.GetAllocatedSize(); }
 };
 
+// Keeps the allocations so a remesh or a recycled chunk does not grow the buffers again
 inline void FChunkMeshData::Clear()
 {
-	Vertices.Empty();
-	Triangles.Empty();
-	Normals.Empty();
-	Colors.Empty();
-	UV0.Empty();
-	BlockData.Empty();
-}
\ No newline at end of file
+	Vertices.Reset();
+	Triangles.Reset();
+}
@@ -0,0 +1,625 @@
+#include "ChunkRegionStore.h"
+
+#include "ChunkData.h"
+#include "ChunkSaveQueue.h"
+#include "VoxelStats.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chunks Restored"), STAT_VoxelChunksRestored, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Region Bytes Mapped"), STAT_VoxelRegionBytesMapped, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Region Bytes Copied"), STAT_VoxelRegionBytesCopied, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mapped Regions"), STAT_VoxelMappedRegions, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Region Bytes Written"), STAT_VoxelRegionBytesWritten, STATGROUP_Voxel);
+
+// File layout: magic, version and chunk size, then an offset and a size per column, all little endian
+static constexpr uint32 RegionMagic = 0x52474354;
+static constexpr uint32 RegionVersion = 1;
+static constexpr int32 ColumnsPerRegion = FChunkRegionStore::RegionSize * FChunkRegionStore::RegionSize;
+static constexpr int32 RegionHeaderSize = 3 * sizeof(uint32) + ColumnsPerRegion * 2 * sizeof(uint32);
+
+static TAutoConsoleVariable<int32> CVarRegionMemoryMapping(
+	TEXT("Voxel.RegionMemoryMapping"),
+	1,
+	TEXT("Read saved chunk regions through memory mapped files. 0 copies every record through buffered reads instead"));
+
+static void WriteUInt32(TArray<uint8>& Out, const uint32 Value)
+{
+	for (int32 Shift = 0; Shift < 32; Shift += 8)
+	{
+		Out.Add(static_cast<uint8>(Value >> Shift));
+	}
+}
+
+// LEB128, runs and palette indices are mostly below 128 and take a single byte
+static void WriteVarInt(TArray<uint8>& Out, uint32 Value)
+{
+	while (Value >= 0x80)
+	{
+		Out.Add(static_cast<uint8>(Value | 0x80));
+		Value >>= 7;
+	}
+	Out.Add(static_cast<uint8>(Value));
+}
+
+// Bounds checked reads from a record, every read past the end returns 0 and sets bError
+struct FRegionReader
+{
+	const uint8* Data;
+	int64 Size;
+	int64 Offset = 0;
+	bool bError = false;
+
+	FRegionReader(const uint8* InData, const int64 InSize) : Data(InData), Size(InSize) {}
+
+	uint8 ReadByte()
+	{
+		if (Offset >= Size)
+		{
+			bError = true;
+			return 0;
+		}
+		return Data[Offset++];
+	}
+
+	uint32 ReadUInt32()
+	{
+		uint32 Value = 0;
+		for (int32 Shift = 0; Shift < 32; Shift += 8)
+		{
+			Value |= uint32(ReadByte()) << Shift;
+		}
+		return Value;
+	}
+
+	uint32 ReadVarInt()
+	{
+		uint32 Value = 0;
+		for (int32 Shift = 0; Shift < 35; Shift += 7)
+		{
+			const uint8 Byte = ReadByte();
+			Value |= uint32(Byte & 0x7f) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return Value;
+			}
+		}
+		bError = true;
+		return 0;
+	}
+
+	const uint8* ReadBytes(const int64 Count)
+	{
+		if (Count < 0 || Count > Size - Offset)
+		{
+			bError = true;
+			return nullptr;
+		}
+		const uint8* Bytes = Data + Offset;
+		Offset += Count;
+		return Bytes;
+	}
+};
+
+// One saved chunk of a column record, pointing into the record's bytes
+struct FChunkRecord
+{
+	int32 Z = 0;
+	const uint8* Data = nullptr;
+	int32 Size = 0;
+};
+
+// Column records start with the number of chunks, then per chunk its zigzag encoded Z and its payload size
+static bool ParseColumnRecord(const uint8* Data, const int64 Size, TArray<FChunkRecord, TInlineAllocator<8>>& OutRecords)
+{
+	FRegionReader Reader(Data, Size);
+	const uint32 NumChunks = Reader.ReadVarInt();
+	for (uint32 i = 0; i < NumChunks && !Reader.bError; ++i)
+	{
+		FChunkRecord Record;
+		const uint32 ZigZag = Reader.ReadVarInt();
+		Record.Z = static_cast<int32>(ZigZag >> 1) ^ -static_cast<int32>(ZigZag & 1);
+		Record.Size = static_cast<int32>(Reader.ReadVarInt());
+		Record.Data = Reader.ReadBytes(Record.Size);
+		OutRecords.Add(Record);
+	}
+	return !Reader.bError;
+}
+
+static void WriteColumnRecord(TArray<uint8>& Out, const TArray<FChunkRecord, TInlineAllocator<8>>& Records)
+{
+	WriteVarInt(Out, Records.Num());
+	for (const FChunkRecord& Record : Records)
+	{
+		WriteVarInt(Out, (static_cast<uint32>(Record.Z) << 1) ^ static_cast<uint32>(Record.Z >> 31));
+		WriteVarInt(Out, Record.Size);
+		Out.Append(Record.Data, Record.Size);
+	}
+}
+
+FChunkRegionStore::FChunkRegionStore(const FString& InDirectory, const int32 InChunkSize, const float CoalesceSeconds)
+	: Directory(InDirectory),
+	ChunkSize(InChunkSize)
+{
+	// A write interrupted between finishing its temporary file and replacing the region file leaves
+	// only the temporary file. One cut short while writing is dropped if the old file is still there,
+	// and fails the offset table check like any unreadable region otherwise
+	TArray<FString> TempFiles;
+	IFileManager::Get().FindFiles(TempFiles, *FPaths::Combine(Directory, TEXT("*.region.tmp")), true, false);
+	for (const FString& TempFile : TempFiles)
+	{
+		const FString TempFilename = FPaths::Combine(Directory, TempFile);
+		const FString Filename = TempFilename.LeftChop(4);
+		if (IFileManager::Get().FileExists(*Filename))
+		{
+			IFileManager::Get().Delete(*TempFilename);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Recovering region file %s from an interrupted save"), *Filename);
+			IFileManager::Get().Move(*Filename, *TempFilename);
+		}
+	}
+
+	SaveQueue = MakeUnique<FChunkSaveQueue>(Directory, ChunkSize, CoalesceSeconds);
+}
+
+FChunkRegionStore::~FChunkRegionStore()
+{
+	// Releases the mappings first, some platforms cannot replace a file that is still mapped
+	Regions.Reset();
+	MappedRegions.Reset();
+	SaveQueue.Reset();
+}
+
+FIntPoint FChunkRegionStore::GetRegion(const FIntVector& ChunkPosition)
+{
+	return FIntPoint(
+		FMath::FloorToInt(ChunkPosition.X / float(RegionSize)),
+		FMath::FloorToInt(ChunkPosition.Y / float(RegionSize)));
+}
+
+int32 FChunkRegionStore::GetColumnIndex(const FIntVector& ChunkPosition)
+{
+	const FIntPoint Region = GetRegion(ChunkPosition);
+	return (ChunkPosition.Y - Region.Y * RegionSize) * RegionSize + (ChunkPosition.X - Region.X * RegionSize);
+}
+
+FString FChunkRegionStore::GetRegionFilename(const FString& RegionDirectory, const FIntPoint& Region)
+{
+	return FPaths::Combine(RegionDirectory, FString::Printf(TEXT("r.%d.%d.region"), Region.X, Region.Y));
+}
+
+bool FChunkRegionStore::ParseTable(const uint8* Data, const int64 Size, const int32 RegionChunkSize, TArray<FColumnEntry>& OutColumns)
+{
+	OutColumns.Reset();
+
+	FRegionReader Reader(Data, FMath::Min<int64>(Size, RegionHeaderSize));
+	if (Reader.ReadUInt32() != RegionMagic || Reader.ReadUInt32() != RegionVersion || Reader.ReadUInt32() != uint32(RegionChunkSize))
+	{
+		return false;
+	}
+
+	OutColumns.SetNum(ColumnsPerRegion);
+	for (FColumnEntry& Entry : OutColumns)
+	{
+		Entry.Offset = Reader.ReadUInt32();
+		Entry.Size = Reader.ReadUInt32();
+		if (Entry.Size > 0 && (Entry.Offset < uint32(RegionHeaderSize) || int64(Entry.Offset) + Entry.Size > Size))
+		{
+			Reader.bError = true;
+		}
+	}
+
+	if (Reader.bError)
+	{
+		OutColumns.Reset();
+		return false;
+	}
+	return true;
+}
+
+bool FChunkRegionStore::MapRegionFile(const FIntPoint& Region, FRegionFile& File)
+{
+	if (File.MappedRegion)
+	{
+		MappedRegions.Remove(Region);
+		MappedRegions.Add(Region);
+		return true;
+	}
+
+	if (CVarRegionMemoryMapping.GetValueOnAnyThread() == 0)
+	{
+		return false;
+	}
+
+	File.MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*GetRegionFilename(Directory, Region)));
+	if (File.MappedFile && File.MappedFile->GetFileSize() > 0)
+	{
+		File.MappedRegion.Reset(File.MappedFile->MapRegion(0, File.MappedFile->GetFileSize()));
+	}
+
+	if (!File.MappedRegion)
+	{
+		File.MappedFile.Reset();
+		return false;
+	}
+
+	MappedRegions.Add(Region);
+	if (MappedRegions.Num() > MaxMappedRegions)
+	{
+		const FIntPoint Oldest = MappedRegions[0];
+		UnmapRegionFile(Oldest, Regions[Oldest]);
+	}
+
+	SET_DWORD_STAT(STAT_VoxelMappedRegions, MappedRegions.Num());
+	return true;
+}
+
+void FChunkRegionStore::UnmapRegionFile(const FIntPoint& Region, FRegionFile& File)
+{
+	File.MappedRegion.Reset();
+	File.MappedFile.Reset();
+	MappedRegions.Remove(Region);
+
+	SET_DWORD_STAT(STAT_VoxelMappedRegions, MappedRegions.Num());
+}
+
+FChunkRegionStore::FRegionFile& FChunkRegionStore::FindOrOpenRegion(const FIntPoint& Region)
+{
+	if (FRegionFile* File = Regions.Find(Region))
+	{
+		return *File;
+	}
+
+	FRegionFile& File = Regions.Add(Region);
+	const FString Filename = GetRegionFilename(Directory, Region);
+
+	bool bIsValid;
+	if (MapRegionFile(Region, File))
+	{
+		bIsValid = ParseTable(File.MappedRegion->GetMappedPtr(), File.MappedRegion->GetMappedSize(), ChunkSize, File.Columns);
+		BytesMapped += RegionHeaderSize;
+		INC_DWORD_STAT_BY(STAT_VoxelRegionBytesMapped, RegionHeaderSize);
+	}
+	else
+	{
+		TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+		if (!Handle)
+		{
+			return File;
+		}
+
+		bIsValid = ReadTable(*Handle, File.Columns);
+	}
+
+	if (!bIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Ignoring region file %s, it is unreadable or not a region of %d^3 chunks"), *Filename, ChunkSize);
+		UnmapRegionFile(Region, File);
+	}
+	return File;
+}
+
+bool FChunkRegionStore::ReadTable(IFileHandle& Handle, TArray<FColumnEntry>& OutColumns)
+{
+	ReadBuffer.SetNumUninitialized(RegionHeaderSize);
+	const int64 FileSize = Handle.Size();
+	const bool bIsValid = Handle.Read(ReadBuffer.GetData(), FMath::Min<int64>(FileSize, RegionHeaderSize)) && ParseTable(ReadBuffer.GetData(), FileSize, ChunkSize, OutColumns);
+	BytesCopied += RegionHeaderSize;
+	INC_DWORD_STAT_BY(STAT_VoxelRegionBytesCopied, RegionHeaderSize);
+	return bIsValid;
+}
+
+const uint8* FChunkRegionStore::ReadColumn(IFileHandle& Handle, const FColumnEntry& Entry)
+{
+	ReadBuffer.SetNumUninitialized(Entry.Size, false);
+	if (!Handle.Seek(Entry.Offset) || !Handle.Read(ReadBuffer.GetData(), Entry.Size))
+	{
+		return nullptr;
+	}
+
+	BytesCopied += Entry.Size;
+	INC_DWORD_STAT_BY(STAT_VoxelRegionBytesCopied, Entry.Size);
+	return ReadBuffer.GetData();
+}
+
+bool FChunkRegionStore::LoadChunk(FChunkData& Chunk)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	// Saved but not written yet
+	if (const TSharedPtr<const FChunkSnapshot> Snapshot = SaveQueue->FindPending(Chunk.ChunkPosition))
+	{
+		Chunk.Blocks = Snapshot->Blocks;
+		Chunk.FloraPositions = Snapshot->FloraPositions;
+		Chunk.bIsRestored = true;
+		INC_DWORD_STAT(STAT_VoxelChunksRestored);
+		return true;
+	}
+
+	const FIntPoint Region = GetRegion(Chunk.ChunkPosition);
+	const FString Filename = GetRegionFilename(Directory, Region);
+	const int32 Column = GetColumnIndex(Chunk.ChunkPosition);
+
+	FColumnEntry Entry;
+	const uint8* ColumnData = nullptr;
+	if (SaveQueue->HasPendingWrites(Region))
+	{
+		// The save queue can replace the file at any moment, the offset table and the record are read
+		// through one handle so both come from the same file
+		TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+		TArray<FColumnEntry> Columns;
+		if (!Handle || !ReadTable(*Handle, Columns) || Columns[Column].Size == 0)
+		{
+			return false;
+		}
+
+		Entry = Columns[Column];
+		ColumnData = ReadColumn(*Handle, Entry);
+	}
+	else
+	{
+		// Only saves queued from here replace the file, and they drop the cached table and mapping
+		FRegionFile& File = FindOrOpenRegion(Region);
+		if (File.Columns.Num() == 0 || File.Columns[Column].Size == 0)
+		{
+			return false;
+		}
+
+		// Mapped files are decoded in place, the others are read into ReadBuffer first
+		Entry = File.Columns[Column];
+		if (MapRegionFile(Region, File))
+		{
+			ColumnData = File.MappedRegion->GetMappedPtr() + Entry.Offset;
+			BytesMapped += Entry.Size;
+			INC_DWORD_STAT_BY(STAT_VoxelRegionBytesMapped, Entry.Size);
+		}
+		else
+		{
+			TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+			ColumnData = Handle ? ReadColumn(*Handle, Entry) : nullptr;
+		}
+	}
+
+	if (!ColumnData)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to read chunk column from %s"), *Filename);
+		return false;
+	}
+
+	TArray<FChunkRecord, TInlineAllocator<8>> Records;
+	if (!ParseColumnRecord(ColumnData, Entry.Size, Records))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Corrupt chunk column in %s"), *Filename);
+		return false;
+	}
+
+	for (const FChunkRecord& Record : Records)
+	{
+		if (Record.Z != Chunk.ChunkPosition.Z)
+			continue;
+
+		if (!DecodeChunk(Record.Data, Record.Size, Chunk))
+		{
+			// Generated from noise instead, the edits of this chunk are lost
+			UE_LOG(LogTemp, Warning, TEXT("Corrupt chunk %s in %s"), *Chunk.ChunkPosition.ToString(), *Filename);
+			Chunk.Blocks.Fill(EBlock::Null);
+			Chunk.FloraPositions.Reset();
+			return false;
+		}
+
+		Chunk.bIsRestored = true;
+		INC_DWORD_STAT(STAT_VoxelChunksRestored);
+		return true;
+	}
+	return false;
+}
+
+void FChunkRegionStore::SaveChunk(FChunkData& Chunk)
+{
+	const TSharedRef<FChunkSnapshot> Snapshot = MakeShared<FChunkSnapshot>();
+	Snapshot->ChunkPosition = Chunk.ChunkPosition;
+	Snapshot->Blocks = Chunk.Blocks;
+	Snapshot->FloraPositions = Chunk.FloraPositions;
+
+	// The file is replaced once the queue writes it. Some platforms cannot replace a file that is
+	// still mapped, and the cached offset table would point into the old file
+	const FIntPoint Region = GetRegion(Chunk.ChunkPosition);
+	FScopeLock Lock(&CriticalSection);
+	if (FRegionFile* File = Regions.Find(Region))
+	{
+		UnmapRegionFile(Region, *File);
+		Regions.Remove(Region);
+	}
+
+	SaveQueue->Enqueue(Snapshot);
+	Chunk.bHasUnsavedEdits = false;
+}
+
+void FChunkRegionStore::Flush()
+{
+	SaveQueue->Flush();
+}
+
+bool FChunkRegionStore::WriteRegionFile(const FString& RegionDirectory, const int32 RegionChunkSize, const FIntPoint& Region, const TMap<FIntVector, TArray<uint8>>& Updates, int64& OutFileSize)
+{
+	const FString Filename = GetRegionFilename(RegionDirectory, Region);
+
+	// The records of the chunks not in Updates are carried over from the current file
+	TArray<uint8> OldFile;
+	TArray<FColumnEntry> OldColumns;
+	if (FFileHelper::LoadFileToArray(OldFile, *Filename, FILEREAD_Silent) && !ParseTable(OldFile.GetData(), OldFile.Num(), RegionChunkSize, OldColumns))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Overwriting unreadable region file %s"), *Filename);
+	}
+
+	TArray<const TPair<FIntVector, TArray<uint8>>*> UpdatesByColumn[ColumnsPerRegion];
+	for (const TPair<FIntVector, TArray<uint8>>& Update : Updates)
+	{
+		check(GetRegion(Update.Key) == Region);
+		UpdatesByColumn[GetColumnIndex(Update.Key)].Add(&Update);
+	}
+
+	TArray<uint8> NewFile;
+	WriteUInt32(NewFile, RegionMagic);
+	WriteUInt32(NewFile, RegionVersion);
+	WriteUInt32(NewFile, RegionChunkSize);
+	NewFile.AddZeroed(ColumnsPerRegion * 2 * sizeof(uint32));
+
+	TArray<FColumnEntry> NewColumns;
+	NewColumns.SetNum(ColumnsPerRegion);
+
+	for (int32 Column = 0; Column < ColumnsPerRegion; ++Column)
+	{
+		TArray<FChunkRecord, TInlineAllocator<8>> Records;
+		if (OldColumns.Num() > 0 && OldColumns[Column].Size > 0)
+		{
+			const FColumnEntry& OldEntry = OldColumns[Column];
+			if (!ParseColumnRecord(OldFile.GetData() + OldEntry.Offset, OldEntry.Size, Records))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Dropping corrupt chunk column %d of %s"), Column, *Filename);
+				Records.Reset();
+			}
+		}
+
+		for (const TPair<FIntVector, TArray<uint8>>* Update : UpdatesByColumn[Column])
+		{
+			Records.RemoveAll([Update](const FChunkRecord& Record) { return Record.Z == Update->Key.Z; });
+
+			FChunkRecord& Record = Records.AddDefaulted_GetRef();
+			Record.Z = Update->Key.Z;
+			Record.Data = Update->Value.GetData();
+			Record.Size = Update->Value.Num();
+		}
+
+		if (Records.Num() == 0)
+			continue;
+
+		Records.Sort([](const FChunkRecord& A, const FChunkRecord& B) { return A.Z < B.Z; });
+
+		FColumnEntry& Entry = NewColumns[Column];
+		Entry.Offset = NewFile.Num();
+		WriteColumnRecord(NewFile, Records);
+		Entry.Size = NewFile.Num() - Entry.Offset;
+	}
+
+	// Fill in the offset table now that every record has its place
+	TArray<uint8> TableBytes;
+	for (const FColumnEntry& Entry : NewColumns)
+	{
+		WriteUInt32(TableBytes, Entry.Offset);
+		WriteUInt32(TableBytes, Entry.Size);
+	}
+	FMemory::Memcpy(NewFile.GetData() + 3 * sizeof(uint32), TableBytes.GetData(), TableBytes.Num());
+
+	// A crash while writing leaves the temporary file behind and the old region file intact
+	const FString TempFilename = Filename + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(NewFile, *TempFilename) || !IFileManager::Get().Move(*Filename, *TempFilename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write region file %s"), *Filename);
+		return false;
+	}
+	INC_DWORD_STAT_BY(STAT_VoxelRegionBytesWritten, NewFile.Num());
+
+	OutFileSize = NewFile.Num();
+	return true;
+}
+
+void FChunkRegionStore::EncodeChunk(const FChunkSnapshot& Snapshot, TArray<uint8>& OutPayload)
+{
+	const TArray<EBlock>& Palette = Snapshot.Blocks.GetPalette();
+	WriteVarInt(OutPayload, Palette.Num());
+	for (const EBlock Block : Palette)
+	{
+		OutPayload.Add(static_cast<uint8>(Block));
+	}
+
+	// Runs follow the block index order, so whole layers of air or stone collapse into a few bytes
+	const int32 NumVoxels = Snapshot.Blocks.Num();
+	for (int32 Start = 0; Start < NumVoxels;)
+	{
+		const int32 PaletteIndex = Snapshot.Blocks.GetPaletteIndexAt(Start);
+		int32 End = Start + 1;
+		while (End < NumVoxels && Snapshot.Blocks.GetPaletteIndexAt(End) == PaletteIndex)
+		{
+			++End;
+		}
+
+		WriteVarInt(OutPayload, End - Start);
+		WriteVarInt(OutPayload, PaletteIndex);
+		Start = End;
+	}
+
+	// Flora sits one block above the chunk's top layer at most, which still fits a byte
+	WriteVarInt(OutPayload, Snapshot.FloraPositions.Num());
+	for (const FDecorationData& Flora : Snapshot.FloraPositions)
+	{
+		OutPayload.Add(static_cast<uint8>(Flora.Position.X));
+		OutPayload.Add(static_cast<uint8>(Flora.Position.Y));
+		OutPayload.Add(static_cast<uint8>(Flora.Position.Z));
+		OutPayload.Add(static_cast<uint8>(Flora.DecorationBlockType));
+		WriteVarInt(OutPayload, Flora.TextureIndex);
+	}
+}
+
+bool FChunkRegionStore::DecodeChunk(const uint8* Data, const int32 Size, FChunkData& Chunk)
+{
+	FRegionReader Reader(Data, Size);
+
+	const uint32 PaletteSize = Reader.ReadVarInt();
+	if (PaletteSize == 0 || PaletteSize > static_cast<uint32>(EBlock::Null) + 1)
+	{
+		return false;
+	}
+
+	TArray<EBlock, TInlineAllocator<32>> Palette;
+	for (uint32 i = 0; i < PaletteSize; ++i)
+	{
+		const uint8 Block = Reader.ReadByte();
+		if (Block > static_cast<uint8>(EBlock::Null))
+		{
+			return false;
+		}
+		Palette.Add(static_cast<EBlock>(Block));
+	}
+	if (Reader.bError)
+	{
+		return false;
+	}
+
+	Chunk.Blocks.InitPalette(Palette);
+
+	const int32 NumVoxels = Chunk.Blocks.Num();
+	for (int32 Start = 0; Start < NumVoxels;)
+	{
+		const uint32 Length = Reader.ReadVarInt();
+		const uint32 PaletteIndex = Reader.ReadVarInt();
+		if (Reader.bError || Length == 0 || Length > uint32(NumVoxels - Start) || PaletteIndex >= PaletteSize)
+		{
+			return false;
+		}
+
+		Chunk.Blocks.SetRun(Start, Length, PaletteIndex);
+		Start += Length;
+	}
+
+	const uint32 NumFlora = Reader.ReadVarInt();
+	Chunk.FloraPositions.Reset();
+	for (uint32 i = 0; i < NumFlora && !Reader.bError; ++i)
+	{
+		FDecorationData Flora;
+		Flora.Position.X = Reader.ReadByte();
+		Flora.Position.Y = Reader.ReadByte();
+		Flora.Position.Z = Reader.ReadByte();
+		Flora.DecorationBlockType = static_cast<EBlock>(FMath::Min(Reader.ReadByte(), static_cast<uint8>(EBlock::Null)));
+		Flora.TextureIndex = Reader.ReadVarInt();
+		Chunk.FloraPositions.Add(Flora);
+	}
+
+	return !Reader.bError && Reader.Offset == Size;
+}
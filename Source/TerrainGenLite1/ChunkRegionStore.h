@@ -0,0 +1,132 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+
+#include <atomic>
+
+class FChunkData;
+class FChunkSaveQueue;
+class IFileHandle;
+struct FChunkSnapshot;
+
+/**
+ * Saves edited chunks to region files and reads them back when the chunks stream in again.
+ *
+ * A region file holds RegionSize x RegionSize chunk columns. It starts with a header and an offset
+ * table with one entry per column, followed by the column records. A column record lists the saved
+ * chunks stacked in it, each as a palette followed by run-length encoded palette indices and the
+ * chunk's flora. Only chunks with edits are written, everything else is generated from noise as before.
+ *
+ * Region files are read through a memory mapping where the platform supports it, the chunk
+ * records are decoded straight from the mapped view into the chunk's palette storage. Otherwise,
+ * or with Voxel.RegionMemoryMapping 0, each column record is copied into a buffer first.
+ *
+ * Saves are snapshots written by an FChunkSaveQueue on its own thread. A chunk that loads again
+ * before its save reached the file is restored from the queued snapshot. A region with writes
+ * pending is neither mapped nor has its offset table kept, so the queue can replace the file.
+ *
+ * LoadChunk runs on the generation workers, the cached offset tables, mappings and read buffer are
+ * guarded by a lock that SaveChunk also takes to drop them. Everything else is game thread only. The
+ * offset table of a region is read on the first chunk it is asked for, and again after a save of the
+ * region was queued.
+ */
+class FChunkRegionStore
+{
+public:
+	// Chunk columns along each side of a region
+	static constexpr int32 RegionSize = 32;
+
+	// Saves wait up to CoalesceSeconds in the save queue for more saves of their region
+	FChunkRegionStore(const FString& InDirectory, int32 InChunkSize, float CoalesceSeconds);
+
+	// Blocks until the save queue wrote every queued snapshot
+	~FChunkRegionStore();
+
+	// Reads the saved blocks of the chunk at Chunk.ChunkPosition into Chunk and marks it restored.
+	// Returns false if the chunk was never saved or its record is unreadable. Safe to call from any thread
+	bool LoadChunk(FChunkData& Chunk);
+
+	// Queues a snapshot of the blocks and flora of Chunk, replacing an earlier save of it in its region file
+	void SaveChunk(FChunkData& Chunk);
+
+	// Blocks until every queued save is written
+	void Flush();
+
+	const FChunkSaveQueue& GetSaveQueue() const { return *SaveQueue; }
+
+	// Chunk payload without the column record around it
+	static void EncodeChunk(const FChunkSnapshot& Snapshot, TArray<uint8>& OutPayload);
+	static bool DecodeChunk(const uint8* Data, int32 Size, FChunkData& Chunk);
+
+	// Rewrites the region file with the payloads in Updates, keyed by chunk position, replacing the
+	// saved chunks they share a position with and keeping every other record. The new file is
+	// written next to the old one and replaces it once complete. Safe to call from any thread as
+	// long as a single thread writes each region
+	static bool WriteRegionFile(const FString& RegionDirectory, int32 RegionChunkSize, const FIntPoint& Region, const TMap<FIntVector, TArray<uint8>>& Updates, int64& OutFileSize);
+
+	static FIntPoint GetRegion(const FIntVector& ChunkPosition);
+	static FString GetRegionFilename(const FString& RegionDirectory, const FIntPoint& Region);
+
+	const FString& GetDirectory() const { return Directory; }
+
+	// Column record bytes decoded from a mapped view, and read through a copy because the file could not be mapped
+	int64 GetBytesMapped() const { return BytesMapped; }
+	int64 GetBytesCopied() const { return BytesCopied; }
+
+	// Regions kept mapped at once, the least recently read one is unmapped past it
+	static constexpr int32 MaxMappedRegions = 8;
+
+private:
+	struct FColumnEntry
+	{
+		uint32 Offset = 0;
+		uint32 Size = 0;
+	};
+
+	struct FRegionFile
+	{
+		// Offset table, empty if the file does not exist
+		TArray<FColumnEntry> Columns;
+
+		// Set while the file is mapped, the region is released before the handle
+		TUniquePtr<IMappedFileHandle> MappedFile;
+		TUniquePtr<IMappedFileRegion> MappedRegion;
+	};
+
+	static int32 GetColumnIndex(const FIntVector& ChunkPosition);
+
+	FRegionFile& FindOrOpenRegion(const FIntPoint& Region);
+
+	// Maps the whole file, false if mapping is disabled or not supported for it
+	bool MapRegionFile(const FIntPoint& Region, FRegionFile& File);
+	void UnmapRegionFile(const FIntPoint& Region, FRegionFile& File);
+
+	// Buffered reads through ReadBuffer, ReadColumn returns the record or null if the read failed
+	bool ReadTable(IFileHandle& Handle, TArray<FColumnEntry>& OutColumns);
+	const uint8* ReadColumn(IFileHandle& Handle, const FColumnEntry& Entry);
+
+	// Parses the header and offset table of a region file of Size bytes, Data holds at least the
+	// header. Returns false if it is not a region of this chunk size
+	static bool ParseTable(const uint8* Data, int64 Size, int32 RegionChunkSize, TArray<FColumnEntry>& OutColumns);
+
+	FString Directory;
+	int32 ChunkSize;
+
+	TUniquePtr<FChunkSaveQueue> SaveQueue;
+
+	// Held by LoadChunk while it reads, and by SaveChunk while it drops the region's cache and queues
+	// the save, so a read that found no writes pending finishes before the queue can replace the file
+	FCriticalSection CriticalSection;
+
+	TMap<FIntPoint, FRegionFile> Regions;
+
+	// Mapped regions, most recently read last
+	TArray<FIntPoint> MappedRegions;
+
+	// Column records of unmapped files are read into this buffer
+	TArray<uint8> ReadBuffer;
+
+	std::atomic<int64> BytesMapped { 0 };
+	std::atomic<int64> BytesCopied { 0 };
+};
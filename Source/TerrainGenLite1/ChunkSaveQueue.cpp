@@ -0,0 +1,205 @@
+#include "ChunkSaveQueue.h"
+
+#include "ChunkRegionStore.h"
+#include "VoxelStats.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chunks Saved"), STAT_VoxelChunksSaved, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chunk Saves Coalesced"), STAT_VoxelChunkSavesCoalesced, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Save Queue Depth"), STAT_VoxelSaveQueueDepth, STATGROUP_Voxel);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Save Flush Latency (ms)"), STAT_VoxelSaveFlushLatency, STATGROUP_Voxel);
+
+// Saves of one region taken off the queue together
+struct FRegionSaveBatch
+{
+	TArray<TSharedRef<const FChunkSnapshot>> Snapshots;
+	double OldestQueuedTime = 0.0;
+};
+
+FChunkSaveQueue::FChunkSaveQueue(const FString& InDirectory, const int32 InChunkSize, const float InCoalesceSeconds)
+	: Directory(InDirectory),
+	ChunkSize(InChunkSize),
+	CoalesceSeconds(InCoalesceSeconds)
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("ChunkSaveQueue"), 0, TPri_BelowNormal);
+}
+
+FChunkSaveQueue::~FChunkSaveQueue()
+{
+	if (Thread)
+	{
+		// Stops the thread, which writes what is left before returning
+		Thread->Kill(true);
+		delete Thread;
+	}
+	else
+	{
+		WriteDueRegions(true);
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+}
+
+void FChunkSaveQueue::Enqueue(const TSharedRef<const FChunkSnapshot>& Snapshot)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	// Keeps the time of the first save, a chunk edited over and over is still written once the window is up
+	if (FPendingSave* Existing = Pending.Find(Snapshot->ChunkPosition))
+	{
+		Existing->Snapshot = Snapshot;
+		INC_DWORD_STAT(STAT_VoxelChunkSavesCoalesced);
+		return;
+	}
+
+	Pending.Add(Snapshot->ChunkPosition, FPendingSave { Snapshot, FPlatformTime::Seconds() });
+	SET_DWORD_STAT(STAT_VoxelSaveQueueDepth, Pending.Num() + Writing.Num());
+}
+
+TSharedPtr<const FChunkSnapshot> FChunkSaveQueue::FindPending(const FIntVector& ChunkPosition) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (const FPendingSave* Save = Pending.Find(ChunkPosition))
+	{
+		return Save->Snapshot;
+	}
+	if (const FPendingSave* Save = Writing.Find(ChunkPosition))
+	{
+		return Save->Snapshot;
+	}
+	return nullptr;
+}
+
+bool FChunkSaveQueue::HasPendingWrites(const FIntPoint& Region) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	for (const TMap<FIntVector, FPendingSave>* Saves : { &Pending, &Writing })
+	{
+		for (const TPair<FIntVector, FPendingSave>& Pair : *Saves)
+		{
+			if (FChunkRegionStore::GetRegion(Pair.Key) == Region)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+int32 FChunkSaveQueue::GetQueueDepth() const
+{
+	FScopeLock Lock(&CriticalSection);
+	return Pending.Num() + Writing.Num();
+}
+
+void FChunkSaveQueue::Flush()
+{
+	if (!Thread)
+	{
+		WriteDueRegions(true);
+		return;
+	}
+
+	++FlushRequests;
+	WakeEvent->Trigger();
+	while (GetQueueDepth() > 0)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+	--FlushRequests;
+}
+
+uint32 FChunkSaveQueue::Run()
+{
+	// Waking a few times per window keeps a save from waiting much longer than CoalesceSeconds
+	const uint32 WaitMilliseconds = FMath::Max(10, FMath::RoundToInt(CoalesceSeconds * 250.0f));
+
+	while (!bStopping)
+	{
+		WakeEvent->Wait(WaitMilliseconds);
+		WriteDueRegions(FlushRequests > 0);
+	}
+
+	WriteDueRegions(true);
+	return 0;
+}
+
+void FChunkSaveQueue::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+void FChunkSaveQueue::WriteDueRegions(const bool bWriteAll)
+{
+	// A region with a due save takes all of its queued saves along, the whole file is rewritten anyway
+	TMap<FIntPoint, FRegionSaveBatch> Batches;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		const double Now = FPlatformTime::Seconds();
+		for (const TPair<FIntVector, FPendingSave>& Pair : Pending)
+		{
+			if (bWriteAll || Now - Pair.Value.QueuedTime >= CoalesceSeconds)
+			{
+				Batches.FindOrAdd(FChunkRegionStore::GetRegion(Pair.Key)).OldestQueuedTime = Now;
+			}
+		}
+
+		for (auto It = Pending.CreateIterator(); It; ++It)
+		{
+			if (FRegionSaveBatch* Batch = Batches.Find(FChunkRegionStore::GetRegion(It.Key())))
+			{
+				Batch->Snapshots.Add(It.Value().Snapshot);
+				Batch->OldestQueuedTime = FMath::Min(Batch->OldestQueuedTime, It.Value().QueuedTime);
+				Writing.Add(It.Key(), It.Value());
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	for (const TPair<FIntPoint, FRegionSaveBatch>& Pair : Batches)
+	{
+		const FIntPoint& Region = Pair.Key;
+		const FRegionSaveBatch& Batch = Pair.Value;
+
+		TMap<FIntVector, TArray<uint8>> Updates;
+		for (const TSharedRef<const FChunkSnapshot>& Snapshot : Batch.Snapshots)
+		{
+			FChunkRegionStore::EncodeChunk(*Snapshot, Updates.Add(Snapshot->ChunkPosition));
+		}
+
+		int64 FileSize = 0;
+		const bool bWritten = FChunkRegionStore::WriteRegionFile(Directory, ChunkSize, Region, Updates, FileSize);
+
+		FScopeLock Lock(&CriticalSection);
+
+		const double Now = FPlatformTime::Seconds();
+		for (const TSharedRef<const FChunkSnapshot>& Snapshot : Batch.Snapshots)
+		{
+			const FPendingSave Save = Writing.FindAndRemoveChecked(Snapshot->ChunkPosition);
+
+			// Retried after another window unless a newer save of the chunk replaces it, or the queue is
+			// being flushed and nothing waits for a retry
+			if (!bWritten && !bWriteAll && !Pending.Contains(Snapshot->ChunkPosition))
+			{
+				Pending.Add(Snapshot->ChunkPosition, FPendingSave { Save.Snapshot, Now });
+			}
+		}
+		SET_DWORD_STAT(STAT_VoxelSaveQueueDepth, Pending.Num() + Writing.Num());
+
+		if (bWritten)
+		{
+			BytesWritten += FileSize;
+			LastFlushLatency = Now - Batch.OldestQueuedTime;
+			INC_DWORD_STAT_BY(STAT_VoxelChunksSaved, Batch.Snapshots.Num());
+			SET_FLOAT_STAT(STAT_VoxelSaveFlushLatency, LastFlushLatency * 1000.0);
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlockData.h"
+#include "PalettedBlockStorage.h"
+#include "HAL/Runnable.h"
+
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+
+// Copy of a chunk's saved state, taken on the game thread and never modified after
+struct FChunkSnapshot
+{
+	FIntVector ChunkPosition;
+	TPalettedBlockStorage<EBlock> Blocks;
+	TArray<FDecorationData> FloraPositions;
+};
+
+/**
+ * Writes chunk snapshots to their region files on a background thread.
+ *
+ * Saves wait in the queue until the oldest one of their region is CoalesceSeconds old, so a chunk
+ * saved again in the meantime replaces its earlier snapshot and a region with several saves is
+ * rewritten once. Every region write goes to a temporary file that replaces the region file when
+ * it is complete, an interrupted write leaves the previous file intact.
+ *
+ * Enqueue, FindPending and Flush are called from the game thread, the queue is locked only to move
+ * snapshots in and out, encoding and file IO run without it.
+ */
+class FChunkSaveQueue : public FRunnable
+{
+public:
+	FChunkSaveQueue(const FString& InDirectory, int32 InChunkSize, float InCoalesceSeconds);
+
+	// Writes everything still queued before the thread exits
+	virtual ~FChunkSaveQueue() override;
+
+	// Replaces a snapshot of the same chunk that is not being written yet
+	void Enqueue(const TSharedRef<const FChunkSnapshot>& Snapshot);
+
+	// Latest snapshot of the chunk that is queued or being written, its region file is not up to date yet
+	TSharedPtr<const FChunkSnapshot> FindPending(const FIntVector& ChunkPosition) const;
+
+	// True while a save of the region is queued or being written, the region file is replaced only then
+	bool HasPendingWrites(const FIntPoint& Region) const;
+
+	// Blocks until every snapshot queued so far is written, a region that fails to write is given up
+	// on instead of retried
+	void Flush();
+
+	// Chunk saves queued or being written
+	int32 GetQueueDepth() const;
+
+	int64 GetBytesWritten() const { return BytesWritten; }
+
+	// Seconds from the oldest save of the last written region being queued to its file being replaced
+	double GetLastFlushLatency() const { return LastFlushLatency; }
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FPendingSave
+	{
+		TSharedRef<const FChunkSnapshot> Snapshot;
+		double QueuedTime;
+	};
+
+	// Writes the regions whose oldest save is due, or all of them
+	void WriteDueRegions(bool bWriteAll);
+
+	FString Directory;
+	int32 ChunkSize;
+	float CoalesceSeconds;
+
+	mutable FCriticalSection CriticalSection;
+	TMap<FIntVector, FPendingSave> Pending;
+	TMap<FIntVector, FPendingSave> Writing;
+
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopping { false };
+	std::atomic<int32> FlushRequests { 0 };
+
+	std::atomic<int64> BytesWritten { 0 };
+	std::atomic<double> LastFlushLatency { 0.0 };
+};
@@ -1,24 +1,50 @@
 #include "ChunkWorld.h"
 #include "ChunkBase.h"
+#include "ChunkData.h"
+#include "ChunkGenerator.h"
+#include "ChunkRegionStore.h"
+#include "ChunkSaveQueue.h"
 #include "NavMesh/NavMeshBoundsVolume.h"
 #include "NavigationSystem.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/Paths.h"
 #include "VoxelGameInstance.h"
-
-// Sets default values
-AChunkWorld::AChunkWorld()
+#include "VoxelFunctionLibrary.h"
+#include "VoxelStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Density Queue"), STAT_VoxelDensityQueue, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Biome Queue"), STAT_VoxelBiomeQueue, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Decoration Queue"), STAT_VoxelDecorationQueue, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Meshing Queue"), STAT_VoxelMeshingQueue, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Upload Queue"), STAT_VoxelUploadQueue, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loaded Chunks"), STAT_VoxelLoadedChunks, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chunk Load Queue"), STAT_VoxelLoadQueue, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Chunks"), STAT_VoxelPooledChunks, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chunk Pool Hits"), STAT_VoxelPoolHits, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chunk Pool Misses"), STAT_VoxelPoolMisses, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Border Faces"), STAT_VoxelBorderFaces, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Border Faces Culled"), STAT_VoxelBorderFacesCulled, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Mesh Upload"), STAT_VoxelMeshUpload, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Border Remesh"), STAT_VoxelBorderRemesh, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Chunk Streaming"), STAT_VoxelStreaming, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Navigation Dirty Areas"), STAT_VoxelNavDirtyAreas, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Empty Chunks"), STAT_VoxelEmptyChunks, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Solid Chunks"), STAT_VoxelSolidChunks, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pending Feature Chunks"), STAT_VoxelPendingFeatureChunks, STATGROUP_Voxel);
+
+// Offset to the neighbouring chunk across a face, faces are ordered +X, +Y, +Z, -X, -Y, -Z
+static FIntVector GetFaceOffset(const int32 Face)
 {
-	PrimaryActorTick.bCanEverTick = false;
-
-	// Initialize BiomeNoise
-	BiomeNoise = MakeUnique<FastNoiseLite>();
-	HumidityNoise = MakeUnique<FastNoiseLite>();
+	FIntVector Offset = FIntVector::ZeroValue;
+	Offset[Face % 3] = Face < 3 ? 1 : -1;
+	return Offset;
 }
 
-void AChunkWorld::OnChunkMeshUpdated()
+// Sets default values
+AChunkWorld::AChunkWorld()
 {
-	UE_LOG(LogTemp, Warning, TEXT("Chunk mesh updated. Updating NavMesh..."));
-	UpdateNavMeshBoundsVolume();
+	// Ticks to upload the chunks finished by the generation pipeline
+	PrimaryActorTick.bCanEverTick = true;
 }
 
 // Called when the game starts or when spawned
@@ -39,7 +65,6 @@ void AChunkWorld::BeginPlay()
 			UE_LOG(LogTemp, Warning, TEXT("World Seed: %d"), WorldSeed);
 
 			Generate3DWorld();
-			UE_LOG(LogTemp, Warning, TEXT("%d Chunks Created"), ChunkCount);
 		}
 		else
 		{
@@ -52,240 +77,734 @@ void AChunkWorld::BeginPlay()
 	}
 }
 
+void AChunkWorld::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Waits for the chunks still being generated before the actors and the region store go away
+	Pipeline.Reset();
+	Generator.Reset();
+
+	// Blocks until the save queue has written everything
+	SaveEditedChunks();
+	RegionStore.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AChunkWorld::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UpdateStreaming();
+	ProcessGeneratedChunks();
+	ProcessBorderRemeshes();
+	ProcessVoxelEdits();
+}
+
+int32 AChunkWorld::GetGenerationQueueDepth(const EChunkGenerationStage Stage) const
+{
+	return Pipeline ? Pipeline->GetQueueDepth(Stage) : 0;
+}
+
+int32 AChunkWorld::GetSaveQueueDepth() const
+{
+	return RegionStore ? RegionStore->GetSaveQueue().GetQueueDepth() : 0;
+}
+
 
 void AChunkWorld::Generate3DWorld()
 {
 	UE_LOG(LogTemp, Warning, TEXT("Generate 3D World"));
 
-	BiomeNoise->SetSeed(WorldSeed);
-	BiomeNoise->SetFrequency(0.010); // Lower frequency for smoother transitions
-	BiomeNoise->SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-	BiomeNoise->SetFractalType(FastNoiseLite::FractalType_FBm);
-	BiomeNoise->SetFractalOctaves(3); // More octaves for detail
-	BiomeNoise->SetCellularReturnType(FastNoiseLite::CellularReturnType_CellValue);
+	Generator = MakeShared<FChunkGenerator>(WorldSeed, Frequency, CaveSampling, CaveLatticeStep,
+		WorldHeightChunks * ChunkSize, TerrainHeight, CaveDepth);
+	WaterSources = MakeUnique<FWaterSourceIndex>(ChunkSize);
+
+	if (bSaveEdits)
+	{
+		// Saves only match the terrain of the seed they were made on
+		RegionStore = MakeUnique<FChunkRegionStore>(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Regions"), FString::FromInt(WorldSeed)), ChunkSize, SaveCoalesceDelay);
+	}
+
+	// Restores saved chunks on the workers, so the store is created first
+	Pipeline = MakeUnique<FChunkGenerationPipeline>(Generator.ToSharedRef(), GenerationWorkerCount, RegionStore.Get());
 
-	HumidityNoise->SetSeed(WorldSeed);
-	HumidityNoise->SetFrequency(0.005); // Matching frequency for aligned transitions
-	HumidityNoise->SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-	HumidityNoise->SetFractalType(FastNoiseLite::FractalType_FBm);
-	HumidityNoise->SetFractalOctaves(3);
-	HumidityNoise->SetCellularReturnType(FastNoiseLite::CellularReturnType_CellValue);
-	HumidityNoise->SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Hybrid);
-	HumidityNoise->SetCellularJitter(2.5f);
+	// Chunks around the player are streamed in from Tick, starting with the first budget now
+	UpdateStreaming();
+}
 
+FVector AChunkWorld::GetStreamingOrigin() const
+{
+	// The pawn may not be possessed during the first frames, stream around the world actor until it is
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController && PlayerController->GetPawn())
+	{
+		return PlayerController->GetPawn()->GetActorLocation();
+	}
+	return GetActorLocation();
+}
 
+void AChunkWorld::UpdateStreaming()
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelStreaming);
+
+	// Whole columns are loaded, the layer only orders the chunks of a column
+	FIntVector Center = UVoxelFunctionLibrary::WorldToChunkPosition(GetStreamingOrigin(), ChunkSize);
+	Center.Z = FMath::Clamp(Center.Z, 0, WorldHeightChunks - 1);
+
+	if (!bHasStreamingCenter || Center != StreamingCenter)
+	{
+		StreamingCenter = Center;
+		bHasStreamingCenter = true;
+
+		UnloadChunksOutOfRange();
+		RebuildLoadQueue();
+	}
+
+	for (int Loads = 0; Loads < MaxChunkLoadsPerFrame && LoadQueue.Num() > 0;)
+	{
+		const FIntVector ChunkPosition = LoadQueue.Pop(false);
+		if (!Chunks.Contains(ChunkPosition))
+		{
+			LoadChunk(ChunkPosition);
+			++Loads;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_VoxelLoadedChunks, Chunks.Num());
+	SET_DWORD_STAT(STAT_VoxelLoadQueue, LoadQueue.Num());
+}
+
+void AChunkWorld::RebuildLoadQueue()
+{
+	LoadQueue.Reset();
+
+	const int LoadDistanceSquared = DrawDistance * DrawDistance;
 	for (int x = -DrawDistance; x <= DrawDistance; x++)
 	{
 		for (int y = -DrawDistance; y <= DrawDistance; ++y)
 		{
-			for (int z = 0; z < 1; ++z)
+			if (x * x + y * y > LoadDistanceSquared)
+				continue;
+
+			for (int z = 0; z < WorldHeightChunks; ++z)
 			{
-				auto Transform = FTransform(
-					FRotator::ZeroRotator,
-					FVector(x * ChunkSize * 100, y * ChunkSize * 100, z * ChunkSize * 100),
-					FVector::OneVector
-				);
+				const FIntVector ChunkPosition(StreamingCenter.X + x, StreamingCenter.Y + y, z);
+				if (!Chunks.Contains(ChunkPosition))
+				{
+					LoadQueue.Add(ChunkPosition);
+				}
+			}
+		}
+	}
+
+	// Farthest column first, LoadQueue is consumed from the back. Within a column the player's layer comes first
+	const FIntVector Center = StreamingCenter;
+	LoadQueue.Sort([Center](const FIntVector& A, const FIntVector& B)
+	{
+		const FIntVector DeltaA = A - Center;
+		const FIntVector DeltaB = B - Center;
+		const int DistanceA = DeltaA.X * DeltaA.X + DeltaA.Y * DeltaA.Y;
+		const int DistanceB = DeltaB.X * DeltaB.X + DeltaB.Y * DeltaB.Y;
+		if (DistanceA != DistanceB)
+		{
+			return DistanceA > DistanceB;
+		}
+		return FMath::Abs(DeltaA.Z) > FMath::Abs(DeltaB.Z);
+	});
+}
+
+void AChunkWorld::UnloadChunksOutOfRange()
+{
+	const int UnloadDistance = DrawDistance + UnloadMargin;
+	const int UnloadDistanceSquared = UnloadDistance * UnloadDistance;
 
-				auto Chunk = GetWorld()->SpawnActorDeferred<AChunkBase>(
-					ChunkType,
-					Transform,
-					this
-				);
+	TArray<AChunkBase*> ChunksToUnload;
+	for (const TPair<FIntVector, AChunkBase*>& Pair : Chunks)
+	{
+		const FIntVector Delta = Pair.Key - StreamingCenter;
+		if (Delta.X * Delta.X + Delta.Y * Delta.Y > UnloadDistanceSquared)
+		{
+			ChunksToUnload.Add(Pair.Value);
+		}
+	}
 
-				Chunk->WorldSeed = WorldSeed;
-				Chunk->Frequency = Frequency;
-				Chunk->LandMaterial = LandMaterial;
-				Chunk->LiquidMaterial = LiquidMaterial;
-				Chunk->ChunkSize = ChunkSize;
-				Chunk->DrawDistance = DrawDistance;
-				Chunk->BlockSize = BlockSize;
-				Chunk->ZRepeat = z;
+	for (AChunkBase* Chunk : ChunksToUnload)
+	{
+		UnloadChunk(Chunk);
+	}
+}
 
-				UGameplayStatics::FinishSpawningActor(Chunk, Transform);
+void AChunkWorld::LoadChunk(const FIntVector& ChunkPosition)
+{
+	AChunkBase* Chunk = AcquireChunk(ChunkPosition);
 
+	// Every chunk of a column reads the same surface heights, sampled by the first one to generate
+	Chunk->GetChunkData()->Column = GetColumn(FIntPoint(ChunkPosition.X, ChunkPosition.Y));
 
-				SetBiomeForChunk(Chunk, x, y, z);
+	// Trees of generated neighbours that reach into the chunk are placed with its own. A chunk the
+	// Density stage restores from its save ignores them
+	if (const TMap<FIntVector, TArray<FFeatureBlock>>* Pending = PendingFeatureBlocks.Find(ChunkPosition))
+	{
+		for (const TPair<FIntVector, TArray<FFeatureBlock>>& Pair : *Pending)
+		{
+			Chunk->GetChunkData()->IncomingFeatureBlocks.Append(Pair.Value);
+			Chunk->GetChunkData()->FeatureSources.Add(Pair.Key);
+		}
+	}
 
-				Chunks.Add(Chunk);
-				// Bind to the OnChunkMeshUpdated delegate
-				Chunk->OnChunkMeshUpdated.AddDynamic(this, &AChunkWorld::OnChunkMeshUpdated);
+	// Neighbours that are already generated are meshed against right away, the rest connect on upload
+	FillMissingHaloFaces(Chunk);
 
-				ChunkCount++;
-				UE_LOG(LogTemp, Warning, TEXT("Finished chunk?"));
+	// Density, biomes, decorations and meshing run on the generation workers
+	Pipeline->Enqueue(Chunk->GetChunkData().ToSharedRef());
+	PendingChunkCount++;
 
-			}
+	Chunks.Add(ChunkPosition, Chunk);
+	ChunkCount++;
+}
+
+TSharedRef<FChunkColumn> AChunkWorld::GetColumn(const FIntPoint& Column)
+{
+	TSharedPtr<FChunkColumn>& Entry = Columns.FindOrAdd(Column);
+	if (!Entry.IsValid())
+	{
+		Entry = MakeShared<FChunkColumn>();
+	}
+	return Entry.ToSharedRef();
+}
+
+void AChunkWorld::UnloadChunk(AChunkBase* Chunk)
+{
+	Chunks.Remove(Chunk->ChunkPosition);
+	ChunkCount--;
+
+	// Columns stream out as a whole, chunks still generating keep their own reference
+	Columns.Remove(FIntPoint(Chunk->ChunkPosition.X, Chunk->ChunkPosition.Y));
+
+	BorderRemeshQueue.Remove(Chunk->ChunkPosition);
+	ModifiedChunks.Remove(Chunk);
+
+	// Trees rooted in the chunk stop reaching into chunks that load later, generating it again hands
+	// them out again. Neighbours that already placed them keep them
+	for (auto It = PendingFeatureBlocks.CreateIterator(); It; ++It)
+	{
+		It.Value().Remove(Chunk->ChunkPosition);
+		if (It.Value().Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	SET_DWORD_STAT(STAT_VoxelPendingFeatureChunks, PendingFeatureBlocks.Num());
+
+	if (Chunk->IsGenerated())
+	{
+		if (RegionStore && Chunk->GetChunkData()->bHasUnsavedEdits)
+		{
+			RegionStore->SaveChunk(*Chunk->GetChunkData());
 		}
+
+		DisconnectNeighbours(Chunk);
+		WaterSources->RemoveChunk(Chunk->ChunkPosition);
 	}
-	GenerateFlora();
-	// Create or update NavMeshBoundsVolume
-	UpdateNavMeshBoundsVolume();
+
+	// A chunk still in the pipeline keeps its data alive and is skipped when it comes out
+	Chunk->DeactivateChunk();
+	ChunkPool.Add(Chunk);
+
+	SET_DWORD_STAT(STAT_VoxelPooledChunks, ChunkPool.Num());
 }
 
-void AChunkWorld::SetBiomeForChunk(AChunkBase* Chunk, int32 ChunkX, int32 ChunkY, int32 ChunkZ)
+void AChunkWorld::SaveEditedChunks()
 {
-	UE_LOG(LogTemp, Warning, TEXT("Set Biome For Chunk"));
+	if (!RegionStore)
+	{
+		return;
+	}
 
-	for (int32 bx = 0; bx < ChunkSize; ++bx)
+	for (const TPair<FIntVector, AChunkBase*>& Pair : Chunks)
 	{
-		for (int32 by = 0; by < ChunkSize; ++by)
+		AChunkBase* Chunk = Pair.Value;
+		if (IsValid(Chunk) && Chunk->IsGenerated() && Chunk->GetChunkData()->bHasUnsavedEdits)
 		{
-			for (int32 bz = 0; bz < ChunkSize; ++bz)
+			RegionStore->SaveChunk(*Chunk->GetChunkData());
+		}
+	}
+}
+
+AChunkBase* AChunkWorld::AcquireChunk(const FIntVector& ChunkPosition)
+{
+	while (ChunkPool.Num() > 0)
+	{
+		AChunkBase* Chunk = ChunkPool.Pop(false);
+		if (!IsValid(Chunk))
+		{
+			continue;
+		}
+
+		PoolHits++;
+		INC_DWORD_STAT(STAT_VoxelPoolHits);
+		SET_DWORD_STAT(STAT_VoxelPooledChunks, ChunkPool.Num());
+
+		Chunk->SetActorLocation(FVector(ChunkPosition * ChunkSize * BlockSize));
+		Chunk->ZRepeat = ChunkPosition.Z;
+		Chunk->ResetChunk(ChunkPosition);
+		return Chunk;
+	}
+
+	PoolMisses++;
+	INC_DWORD_STAT(STAT_VoxelPoolMisses);
+	return SpawnChunk(ChunkPosition);
+}
+
+AChunkBase* AChunkWorld::SpawnChunk(const FIntVector& ChunkPosition)
+{
+	auto Transform = FTransform(
+		FRotator::ZeroRotator,
+		FVector(ChunkPosition * ChunkSize * BlockSize),
+		FVector::OneVector
+	);
+
+	auto Chunk = GetWorld()->SpawnActorDeferred<AChunkBase>(
+		ChunkType,
+		Transform,
+		this
+	);
+
+	Chunk->WorldSeed = WorldSeed;
+	Chunk->Frequency = Frequency;
+	Chunk->LandMaterial = LandMaterial;
+	Chunk->LiquidMaterial = LiquidMaterial;
+	Chunk->ChunkSize = ChunkSize;
+	Chunk->DrawDistance = DrawDistance;
+	Chunk->BlockSize = BlockSize;
+	Chunk->ZRepeat = ChunkPosition.Z;
+	Chunk->ChunkPosition = ChunkPosition;
+	Chunk->Mesher = Mesher;
+
+	UGameplayStatics::FinishSpawningActor(Chunk, Transform);
+
+	Chunk->OnChunkVoxelsModified.AddDynamic(this, &AChunkWorld::OnChunkVoxelsModified);
+
+	return Chunk;
+}
+
+void AChunkWorld::ProcessGeneratedChunks()
+{
+	if (!Pipeline)
+	{
+		return;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_VoxelMeshUpload);
+
+		TSharedPtr<FChunkData> ChunkData;
+		for (int Uploads = 0; Uploads < MaxMeshUploadsPerFrame && Pipeline->DequeueCompleted(ChunkData); ++Uploads)
+		{
+			PendingChunkCount--;
+			GeneratedChunkCount++;
+
+			DensitySeconds += ChunkData->Timings.Density;
+			BiomeAssignmentSeconds += ChunkData->Timings.Biome;
+			DecorationSeconds += ChunkData->Timings.Decoration;
+			MeshingSeconds += ChunkData->Timings.Meshing;
+
+			if (ChunkData->Contents == EChunkContents::Empty)
+			{
+				INC_DWORD_STAT(STAT_VoxelEmptyChunks);
+			}
+			else if (ChunkData->Contents == EChunkContents::Solid)
 			{
-				float Xpos = bx + ChunkX * ChunkSize;
-				float Ypos = by + ChunkY * ChunkSize;
-				float Zpos = bz + ChunkZ * ChunkSize;
+				INC_DWORD_STAT(STAT_VoxelSolidChunks);
+			}
 
-				// Calculate local coordinates within the chunk
-				int32 LocalX = bx;
-				int32 LocalY = by;
-				int32 LocalZ = bz;
+			// The chunk may have been unloaded, and possibly loaded again, while it was generating
+			AChunkBase** FoundChunk = Chunks.Find(ChunkData->ChunkPosition);
+			if (FoundChunk && IsValid(*FoundChunk) && (*FoundChunk)->GetChunkData() == ChunkData)
+			{
+				AChunkBase* Chunk = *FoundChunk;
 
-				// Sample noise for biome generation
-				float NoiseValue = BiomeNoise->GetNoise(Xpos, Ypos);
-				float HumidityValue = HumidityNoise->GetNoise(Xpos, Ypos);
+				// Neighbours that generated while the chunk was in the pipeline may reach into it
+				if (ApplyPendingFeatureBlocks(*ChunkData))
+				{
+					ChunkData->RebuildDirtySections();
+				}
 
-				// Determine biome type based on noise values
-				EBiome BiomeType = GetBiomeType(NoiseValue, HumidityValue);
+				Chunk->OnGenerationComplete();
+				WaterSources->AddChunk(Chunk->ChunkPosition, ChunkData->WaterSources);
+				ConnectNeighbours(Chunk);
+				DistributeFeatureBlocks(Chunk);
+				GenerateFlora(Chunk);
+			}
 
-				// Set biome type and humidity for the block in the chunk
-				Chunk->SetBiome(LocalX, LocalY, LocalZ, BiomeType, HumidityValue);
+			if (PendingChunkCount == 0 && LoadQueue.Num() == 0)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%d chunks loaded, chunk pool %d hits / %d misses. Generation cost per chunk: density %.3f ms (%s caves), biome assignment %.3f ms, decoration %.3f ms, meshing %.3f ms (%s, %d workers)"),
+					ChunkCount, PoolHits, PoolMisses, DensitySeconds * 1000.0 / GeneratedChunkCount, *UEnum::GetValueAsString(CaveSampling), BiomeAssignmentSeconds * 1000.0 / GeneratedChunkCount,
+					DecorationSeconds * 1000.0 / GeneratedChunkCount, MeshingSeconds * 1000.0 / GeneratedChunkCount,
+					*UEnum::GetValueAsString(Mesher), Pipeline->GetNumWorkers());
+				UpdateBorderFaceStats();
+
+				// Create or update NavMeshBoundsVolume
+				UpdateNavMeshBoundsVolume();
 			}
 		}
 	}
-	Chunk->RegenerateChunkBlockTextures();
 
+	SET_DWORD_STAT(STAT_VoxelDensityQueue, Pipeline->GetQueueDepth(EChunkGenerationStage::Density));
+	SET_DWORD_STAT(STAT_VoxelBiomeQueue, Pipeline->GetQueueDepth(EChunkGenerationStage::Biome));
+	SET_DWORD_STAT(STAT_VoxelDecorationQueue, Pipeline->GetQueueDepth(EChunkGenerationStage::Decoration));
+	SET_DWORD_STAT(STAT_VoxelMeshingQueue, Pipeline->GetQueueDepth(EChunkGenerationStage::Meshing));
+	SET_DWORD_STAT(STAT_VoxelUploadQueue, Pipeline->GetQueueDepth(EChunkGenerationStage::Upload));
 }
 
 
 
-// Function to map noise value to EBiome enum
-// -1 Noise == Coldest, +1 Noise == Hottest
-EBiome AChunkWorld::GetBiomeType(float NoiseValue, float Humidity) const
+AChunkBase* AChunkWorld::FindGeneratedChunk(const FIntVector& ChunkPosition) const
+{
+	AChunkBase* const* FoundChunk = Chunks.Find(ChunkPosition);
+	if (FoundChunk && IsValid(*FoundChunk) && (*FoundChunk)->IsGenerated())
+	{
+		return *FoundChunk;
+	}
+	return nullptr;
+}
+
+bool AChunkWorld::FillMissingHaloFaces(AChunkBase* Chunk) const
 {
-	// Ensure NoiseValue and Humidity are within [-1, 1]
-	NoiseValue = FMath::Clamp(NoiseValue, -1.0f, 1.0f);
-	Humidity = FMath::Clamp(Humidity, -1.0f, 1.0f);
+	FChunkData& ChunkData = *Chunk->GetChunkData();
 
-	// Adjust thresholds for smooth transitions
-	if (NoiseValue < -0.6f)
+	bool bFilledAny = false;
+	for (int32 Face = 0; Face < 6; ++Face)
 	{
-		if (Humidity < -0.6f)
-		{
-			return EBiome::Tundra;   // Cold and dry
-		}
-		else if (Humidity < 0.4f)
-		{
-			return EBiome::Taiga;    // Cold and moderately wet
-		}
-		else
+		if (ChunkData.HasHaloFace(Face))
+			continue;
+
+		if (const AChunkBase* Neighbour = FindGeneratedChunk(Chunk->ChunkPosition + GetFaceOffset(Face)))
 		{
-			return EBiome::Swamp;    // Cold and wet
+			ChunkData.CopyHaloFace(Face, *Neighbour->GetChunkData());
+			bFilledAny = true;
 		}
 	}
-	else if (NoiseValue < 0.0f)
+	return bFilledAny;
+}
+
+void AChunkWorld::ConnectNeighbours(AChunkBase* Chunk)
+{
+	FChunkData& ChunkData = *Chunk->GetChunkData();
+	for (int32 Face = 0; Face < 6; ++Face)
 	{
-		if (Humidity < -0.2f)
+		AChunkBase* Neighbour = FindGeneratedChunk(Chunk->ChunkPosition + GetFaceOffset(Face));
+		if (!Neighbour)
+			continue;
+
+		// Neighbours that finished while this chunk was generating were meshed as Air, and ones edited
+		// meanwhile could not refresh a halo of a chunk that was not generated yet
+		if (!ChunkData.HasHaloFace(Face))
 		{
-			return EBiome::Plains;   // Moderate and dry
+			ChunkData.CopyHaloFace(Face, *Neighbour->GetChunkData());
+			BorderRemeshQueue.Add(Chunk->ChunkPosition);
 		}
-		else if (Humidity < 0.4f)
+		else if (ChunkData.RefreshHaloFace(Face, *Neighbour->GetChunkData()))
 		{
-			return EBiome::Taiga;    // Moderate and moderately wet
+			BorderRemeshQueue.Add(Chunk->ChunkPosition);
 		}
-		else
+
+		const int32 OppositeFace = (Face + 3) % 6;
+		FChunkData& NeighbourData = *Neighbour->GetChunkData();
+		if (!NeighbourData.HasHaloFace(OppositeFace))
+		{
+			NeighbourData.CopyHaloFace(OppositeFace, ChunkData);
+			BorderRemeshQueue.Add(Neighbour->ChunkPosition);
+		}
+	}
+}
+
+void AChunkWorld::DisconnectNeighbours(AChunkBase* Chunk)
+{
+	// The neighbours keep their current meshes, the halo is refreshed when a chunk loads here again
+	for (int32 Face = 0; Face < 6; ++Face)
+	{
+		if (AChunkBase* Neighbour = FindGeneratedChunk(Chunk->ChunkPosition + GetFaceOffset(Face)))
 		{
-			return EBiome::Swamp;    // Moderate and wet
+			Neighbour->GetChunkData()->ClearHaloFace((Face + 3) % 6);
 		}
 	}
-	else if (NoiseValue < 0.4f)
+}
+
+void AChunkWorld::ProcessBorderRemeshes()
+{
+	if (BorderRemeshQueue.Num() == 0)
+	{
+		return;
+	}
+
 	{
-		if (Humidity < -0.2f)
+		SCOPE_CYCLE_COUNTER(STAT_VoxelBorderRemesh);
+
+		int Remeshes = 0;
+		for (auto It = BorderRemeshQueue.CreateIterator(); It && Remeshes < MaxBorderRemeshesPerFrame; ++It)
 		{
-			return EBiome::Plains;   // Warm and dry
+			if (AChunkBase* Chunk = FindGeneratedChunk(*It))
+			{
+				Chunk->RemeshDirtySections();
+				++Remeshes;
+			}
+			It.RemoveCurrent();
 		}
-		else if (Humidity < 0.4f)
+	}
+
+	UpdateBorderFaceStats();
+}
+
+void AChunkWorld::UpdateBorderFaceStats() const
+{
+	int32 BorderFaces = 0;
+	int32 CulledBorderFaces = 0;
+	for (const TPair<FIntVector, AChunkBase*>& Pair : Chunks)
+	{
+		if (IsValid(Pair.Value) && Pair.Value->IsGenerated())
 		{
-			return EBiome::Swamp;    // Warm and moderately wet
+			BorderFaces += Pair.Value->GetChunkData()->GetBorderFaceCount();
+			CulledBorderFaces += Pair.Value->GetChunkData()->GetCulledBorderFaceCount();
 		}
-		else
+	}
+
+	SET_DWORD_STAT(STAT_VoxelBorderFaces, BorderFaces);
+	SET_DWORD_STAT(STAT_VoxelBorderFacesCulled, CulledBorderFaces);
+
+	if (BorderFaces + CulledBorderFaces > 0 && BorderRemeshQueue.Num() == 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Chunk border faces: %d meshed, %d hidden by neighbours (%.1f%% fewer)"),
+			BorderFaces, CulledBorderFaces, CulledBorderFaces * 100.0f / (BorderFaces + CulledBorderFaces));
+	}
+}
+
+void AChunkWorld::OnChunkVoxelsModified(AChunkBase* Chunk, const TArray<FIntVector>& Positions)
+{
+	if (!Chunk->IsGenerated())
+	{
+		return;
+	}
+
+	ModifiedChunks.AddUnique(Chunk);
+
+	WaterSources->UpdateBlocks(Chunk->ChunkPosition, Positions, *Chunk->GetChunkData());
+
+	// Edits keep pushing the navigation update back until they settle
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (!PendingNavigationBounds.IsValid)
+	{
+		FirstNavigationEditTime = Now;
+	}
+	LastNavigationEditTime = Now;
+	PendingNavigationBounds += Chunk->GetVoxelBounds(Positions);
+
+	// Edits and the water they let in can reach any border, comparing the six faces is cheap next to
+	// a remesh and only the neighbour sections whose halo actually changed are rebuilt
+	RefreshNeighbourHalos(Chunk);
+}
+
+void AChunkWorld::RefreshNeighbourHalos(const AChunkBase* Chunk)
+{
+	for (int32 Face = 0; Face < 6; ++Face)
+	{
+		if (AChunkBase* Neighbour = FindGeneratedChunk(Chunk->ChunkPosition + GetFaceOffset(Face)))
 		{
-			return EBiome::Taiga;    // Warm and wet
+			if (Neighbour->GetChunkData()->RefreshHaloFace((Face + 3) % 6, *Chunk->GetChunkData()))
+			{
+				BorderRemeshQueue.Add(Neighbour->ChunkPosition);
+			}
 		}
 	}
-	else
+}
+
+bool AChunkWorld::ApplyPendingFeatureBlocks(FChunkData& ChunkData) const
+{
+	const TMap<FIntVector, TArray<FFeatureBlock>>* Pending = PendingFeatureBlocks.Find(ChunkData.ChunkPosition);
+	if (!Pending)
 	{
-		if (Humidity < 0.0f)
+		return false;
+	}
+
+	bool bChanged = false;
+	for (const TPair<FIntVector, TArray<FFeatureBlock>>& Pair : *Pending)
+	{
+		bool bAlreadyApplied = false;
+		ChunkData.FeatureSources.Add(Pair.Key, &bAlreadyApplied);
+		if (!bAlreadyApplied)
 		{
-			return EBiome::Desert;   // Hot and dry
+			bChanged |= ChunkData.ApplyFeatureBlocks(Pair.Value);
 		}
-		else if (Humidity < 0.4f)
+	}
+	return bChanged;
+}
+
+void AChunkWorld::DistributeFeatureBlocks(AChunkBase* Chunk)
+{
+	FChunkData& ChunkData = *Chunk->GetChunkData();
+	for (TPair<FIntVector, TArray<FFeatureBlock>>& Pair : ChunkData.OverflowFeatureBlocks)
+	{
+		// Nothing streams in above or below the world
+		const FIntVector& Target = Pair.Key;
+		if (Target.Z < 0 || Target.Z >= WorldHeightChunks)
+			continue;
+
+		PendingFeatureBlocks.FindOrAdd(Target).Add(Chunk->ChunkPosition, MoveTemp(Pair.Value));
+
+		// A neighbour still in the pipeline picks them up when it is uploaded, one that is not loaded when it is queued
+		if (AChunkBase* Neighbour = FindGeneratedChunk(Target))
 		{
-			return EBiome::Plains;   // Hot and moderately wet
+			if (ApplyPendingFeatureBlocks(*Neighbour->GetChunkData()))
+			{
+				BorderRemeshQueue.Add(Target);
+				RefreshNeighbourHalos(Neighbour);
+			}
 		}
-		else
+	}
+	ChunkData.OverflowFeatureBlocks.Reset();
+
+	SET_DWORD_STAT(STAT_VoxelPendingFeatureChunks, PendingFeatureBlocks.Num());
+}
+
+void AChunkWorld::ProcessVoxelEdits()
+{
+	if (ModifiedChunks.Num() > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Voxel edits remeshed in %d chunks"), ModifiedChunks.Num());
+		OnVoxelsModified.Broadcast(ModifiedChunks);
+
+		// Saved right away, the save queue merges the saves of chunks edited again soon after
+		for (AChunkBase* Chunk : ModifiedChunks)
 		{
-			return EBiome::Swamp;    // Hot and wet
+			if (RegionStore && IsValid(Chunk) && Chunk->IsGenerated() && Chunk->GetChunkData()->bHasUnsavedEdits)
+			{
+				RegionStore->SaveChunk(*Chunk->GetChunkData());
+			}
 		}
+		ModifiedChunks.Reset();
 	}
+
+	UpdateNavigationDirtyArea();
 }
 
+void AChunkWorld::UpdateNavigationDirtyArea()
+{
+	if (!PendingNavigationBounds.IsValid)
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastNavigationEditTime < NavigationUpdateDelay && Now - FirstNavigationEditTime < NavigationUpdateDelay * 4)
+	{
+		return;
+	}
+
+	// The navmesh rebuilds the tiles overlapping a dirty area on its background tasks, a full Build()
+	// would regenerate every tile inside the bounds volume and block the game thread
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSys->AddDirtyArea(PendingNavigationBounds, ENavigationDirtyFlag::All);
+		INC_DWORD_STAT(STAT_VoxelNavDirtyAreas);
+		UE_LOG(LogTemp, Log, TEXT("Navigation dirty area %s"), *PendingNavigationBounds.GetSize().ToString());
+	}
+
+	PendingNavigationBounds = FBox(ForceInit);
+}
 
+void AChunkWorld::ModifyVoxelAtLocation(const FVector& Location, const EBlock Block)
+{
+	ModifyVoxelsAtLocations({ Location }, { Block });
+}
 
-float AChunkWorld::CalculateHumidity(AChunkBase* Chunk, int32 bx, int32 by, int32 bz)
+void AChunkWorld::ModifyVoxelsAtLocations(const TArray<FVector>& Locations, const TArray<EBlock>& Blocks)
 {
-	FVector BlockPosition = Chunk->GetActorLocation() + FVector(bx, by, bz) * BlockSize;
-	FVector WaterSourcePosition = GetNearestWaterSource(BlockPosition);
+	if (Locations.Num() != Blocks.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ModifyVoxelsAtLocations: %d locations but %d blocks, ignoring the batch"), Locations.Num(), Blocks.Num());
+		return;
+	}
+
+	// Group the edits per chunk so each chunk takes a single batch
+	TMap<AChunkBase*, TPair<TArray<FIntVector>, TArray<EBlock>>> EditsPerChunk;
+	for (int32 i = 0; i < Locations.Num(); ++i)
+	{
+		AChunkBase* Chunk = FindGeneratedChunk(UVoxelFunctionLibrary::WorldToChunkPosition(Locations[i], ChunkSize));
+		if (!Chunk)
+			continue;
 
-	float MaxDistance = 1000.0f;
-	float DistanceToWater = FVector::Dist(WaterSourcePosition, BlockPosition);
-	float Humidity = FMath::Clamp(1.0f - (DistanceToWater / MaxDistance), 0.0f, 1.0f);
+		TPair<TArray<FIntVector>, TArray<EBlock>>& Edits = EditsPerChunk.FindOrAdd(Chunk);
+		Edits.Key.Add(UVoxelFunctionLibrary::WorldToLocalBlockPosition(Locations[i], ChunkSize));
+		Edits.Value.Add(Blocks[i]);
+	}
 
-	return Humidity;
+	for (const TPair<AChunkBase*, TPair<TArray<FIntVector>, TArray<EBlock>>>& Pair : EditsPerChunk)
+	{
+		Pair.Key->ModifyVoxels(Pair.Value.Key, Pair.Value.Value);
+	}
 }
 
-FVector AChunkWorld::GetNearestWaterSource(const FVector& Position)
+
+
+float AChunkWorld::CalculateHumidity(AChunkBase* Chunk, int32 bx, int32 by, int32 bz) const
 {
-	FVector NearestWaterSource = FVector::ZeroVector;
-	float NearestDistanceSquared = FLT_MAX;
+	// Read from the chunk's distance-to-water field, kept up to date by the water source index
+	return Chunk->GetBlockData(FIntVector(bx, by, bz)).Humidity;
+}
+
+void AChunkWorld::CalculateChunkHumidity(AChunkBase* Chunk, TArray<float>& OutHumidity) const
+{
+	OutHumidity.Reset();
+	if (!Chunk || !Chunk->IsGenerated() || !WaterSources)
+	{
+		return;
+	}
 
-	// Iterate over all chunks
-	for (AChunkBase* Chunk : Chunks)
+	const FChunkWaterSources& Sources = Chunk->GetChunkData()->WaterSources;
+	OutHumidity.SetNumUninitialized(ChunkSize * ChunkSize * ChunkSize);
+	for (int bz = 0; bz < ChunkSize; ++bz)
 	{
-		// Iterate over all blocks in the chunk
-		for (int bx = 0; bx < ChunkSize; ++bx)
+		for (int by = 0; by < ChunkSize; ++by)
 		{
-			for (int by = 0; by < ChunkSize; ++by)
+			for (int bx = 0; bx < ChunkSize; ++bx)
 			{
-				for (int bz = 0; bz < ChunkSize; ++bz)
-				{
-					int BlockIndex = Chunk->GetBlockIndex(bx, by, bz);
-					EBlock BlockType = Chunk->Blocks[BlockIndex].Mask.BlockType;
-
-					// Check if the block is shallow or deep water
-					if (BlockType == EBlock::ShallowWater || BlockType == EBlock::DeepWater || BlockType == EBlock::Ice)
-					{
-						// Calculate water block position based on chunk and block indices
-						FVector WaterBlockPosition = Chunk->GetActorLocation() + FVector(bx, by, bz) * BlockSize;
-
-						// Calculate squared distance to the provided Position
-						float DistanceSquared = FVector::DistSquared(WaterBlockPosition, Position);
-
-						// Update nearest water source if closer than current nearest
-						if (DistanceSquared < NearestDistanceSquared)
-						{
-							NearestDistanceSquared = DistanceSquared;
-							NearestWaterSource = WaterBlockPosition;
-						}
-					}
-				}
+				OutHumidity[Chunk->GetBlockIndex(bx, by, bz)] = Sources.GetHumidity(FIntVector(bx, by, bz));
 			}
 		}
 	}
+}
 
-	// Return the nearest water source position found
+FVector AChunkWorld::GetNearestWaterSource(const FVector& Position) const
+{
+	// Zero when there is no water, as callers have always treated it
+	FVector NearestWaterSource = FVector::ZeroVector;
+	FindNearestWaterSource(Position, NearestWaterSource);
 	return NearestWaterSource;
 }
 
+bool AChunkWorld::FindNearestWaterSource(const FVector& Location, FVector& OutWaterLocation) const
+{
+	// The index works in voxel units, chunks are placed at ChunkPosition * ChunkSize * BlockSize
+	FIntVector WaterBlock;
+	if (!WaterSources || !WaterSources->FindNearest(Location / BlockSize, WaterBlock))
+	{
+		return false;
+	}
+
+	OutWaterLocation = FVector(WaterBlock) * BlockSize;
+	return true;
+}
+
+float AChunkWorld::GetDistanceToWater(const FVector& Location, const float MaxDistance) const
+{
+	if (!WaterSources)
+	{
+		return MaxDistance;
+	}
+	return WaterSources->GetDistanceToWater(Location / BlockSize, MaxDistance / BlockSize) * BlockSize;
+}
+
 
 void AChunkWorld::UpdateNavMeshBoundsVolume()
 {
@@ -304,35 +823,34 @@ void AChunkWorld::UpdateNavMeshBoundsVolume()
 			// Adjust the extent to define the area around the player for the navmesh
 			FVector WorldExtent = FVector(ChunkSize * DrawDistance, ChunkSize * DrawDistance, ChunkSize * DrawDistance * 2);
 
-			// Find or spawn the NavMeshBoundsVolume
-			ANavMeshBoundsVolume* NavMeshBounds = nullptr;
-			TArray<AActor*> FoundNavMeshVolumes;
-			UGameplayStatics::GetAllActorsOfClass(GetWorld(), ANavMeshBoundsVolume::StaticClass(), FoundNavMeshVolumes);
-
-			if (FoundNavMeshVolumes.Num() > 0)
-			{
-				NavMeshBounds = Cast<ANavMeshBoundsVolume>(FoundNavMeshVolumes[0]);
-			}
-			else
+			// Find or spawn the NavMeshBoundsVolume, once
+			if (!IsValid(NavMeshBoundsVolume))
 			{
-				NavMeshBounds = GetWorld()->SpawnActor<ANavMeshBoundsVolume>();
+				TArray<AActor*> FoundNavMeshVolumes;
+				UGameplayStatics::GetAllActorsOfClass(GetWorld(), ANavMeshBoundsVolume::StaticClass(), FoundNavMeshVolumes);
+
+				if (FoundNavMeshVolumes.Num() > 0)
+				{
+					NavMeshBoundsVolume = Cast<ANavMeshBoundsVolume>(FoundNavMeshVolumes[0]);
+				}
+				else
+				{
+					NavMeshBoundsVolume = GetWorld()->SpawnActor<ANavMeshBoundsVolume>();
+				}
 			}
 
-			if (NavMeshBounds)
+			if (NavMeshBoundsVolume)
 			{
 				// Set the size and position of the NavMeshBoundsVolume around the player
-				NavMeshBounds->SetActorLocation(WorldCenter);
-				NavMeshBounds->SetActorScale3D(WorldExtent);
+				NavMeshBoundsVolume->SetActorLocation(WorldCenter);
+				NavMeshBoundsVolume->SetActorScale3D(WorldExtent);
 
-				// Force navigation rebuild
+				// With runtime generation the navmesh adds and drops the tiles entering or leaving
+				// the bounds asynchronously, tiles that stay inside are kept
 				UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
 				if (NavSys)
 				{
-					// Notify the navigation system that the bounds have changed
-					NavSys->OnNavigationBoundsUpdated(NavMeshBounds);
-
-					// Optionally trigger a rebuild for immediate updates
-					NavSys->Build(); // Use with caution as this can cause lag
+					NavSys->OnNavigationBoundsUpdated(NavMeshBoundsVolume);
 				}
 			}
 		}
@@ -340,7 +858,7 @@ void AChunkWorld::UpdateNavMeshBoundsVolume()
 }
 
 
-void AChunkWorld::GenerateFlora()
+void AChunkWorld::GenerateFlora(AChunkBase* Chunk)
 {
 	// Ensure the FloraBlueprint is valid
 	if (!FloraBlueprint)
@@ -349,67 +867,61 @@ void AChunkWorld::GenerateFlora()
 		return;
 	}
 
-	// Loop through all chunks
-	for (AChunkBase* Chunk : Chunks)
+	// Ensure Chunk is valid
+	if (!Chunk)
 	{
-		// Ensure Chunk is valid
-		if (!Chunk)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Found invalid chunk. Skipping."));
-			continue;
-		}
+		UE_LOG(LogTemp, Warning, TEXT("Found invalid chunk. Skipping."));
+		return;
+	}
 
-		// Get the local flora data for this chunk
-		TArray<FDecorationData> LocalFloraData = Chunk->GetFloraPositions();
+	// Get the local flora data for this chunk
+	// Most streamed chunks have none
+	TArray<FDecorationData> LocalFloraData = Chunk->GetFloraPositions();
 
-		if (LocalFloraData.Num() == 0)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("No flora data found for chunk at %s"), *Chunk->GetActorLocation().ToString());
-		}
+	// Loop through each decoration data entry
+	for (const FDecorationData& DecorationData : LocalFloraData)
+	{
+		// Calculate spawn location based on chunk and decoration data
+		FVector SpawnLocation = Chunk->GetActorLocation() + FVector(DecorationData.Position.X, DecorationData.Position.Y, DecorationData.Position.Z) * BlockSize;
 
-		// Loop through each decoration data entry
-		for (const FDecorationData& DecorationData : LocalFloraData)
-		{
-			// Calculate spawn location based on chunk and decoration data
-			FVector SpawnLocation = Chunk->GetActorLocation() + FVector(DecorationData.Position.X, DecorationData.Position.Y, DecorationData.Position.Z) * BlockSize;
+		// Log the spawn location and texture index for debugging
+		UE_LOG(LogTemp, Verbose, TEXT("Spawning flora at %s with TextureIndex: %d"), *SpawnLocation.ToString(), DecorationData.TextureIndex);
 
-			// Log the spawn location and texture index for debugging
-			UE_LOG(LogTemp, Log, TEXT("Spawning flora at %s with TextureIndex: %d"), *SpawnLocation.ToString(), DecorationData.TextureIndex);
+		// Set spawn parameters
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
 
-			// Set spawn parameters
-			FActorSpawnParameters SpawnParams;
-			SpawnParams.Owner = this;
+		// Spawn the Flora blueprint actor at the specified location
+		AActor* SpawnedFlora = GetWorld()->SpawnActor<AActor>(FloraBlueprint, SpawnLocation, FRotator::ZeroRotator, SpawnParams);
 
-			// Spawn the Flora blueprint actor at the specified location
-			AActor* SpawnedFlora = GetWorld()->SpawnActor<AActor>(FloraBlueprint, SpawnLocation, FRotator::ZeroRotator, SpawnParams);
+		// Check if the flora was spawned successfully
+		if (SpawnedFlora)
+		{
+			Chunk->AddDecorationActor(SpawnedFlora);
 
-			// Check if the flora was spawned successfully
-			if (SpawnedFlora)
-			{
-				// Log success
-				UE_LOG(LogTemp, Log, TEXT("Successfully spawned flora actor at %s"), *SpawnLocation.ToString());
+			// Log success
+			UE_LOG(LogTemp, Verbose, TEXT("Successfully spawned flora actor at %s"), *SpawnLocation.ToString());
 
-				// If the spawned actor is valid, call the SetDecorationData function in BP_Flora
-				UFunction* SetDecorationDataFunc = SpawnedFlora->FindFunction(TEXT("SetDecorationData"));
-				if (SetDecorationDataFunc)
-				{
-					// Log the function being called
-					UE_LOG(LogTemp, Log, TEXT("Calling SetDecorationData on %s"), *SpawnedFlora->GetName());
+			// If the spawned actor is valid, call the SetDecorationData function in BP_Flora
+			UFunction* SetDecorationDataFunc = SpawnedFlora->FindFunction(TEXT("SetDecorationData"));
+			if (SetDecorationDataFunc)
+			{
+				// Log the function being called
+				UE_LOG(LogTemp, Verbose, TEXT("Calling SetDecorationData on %s"), *SpawnedFlora->GetName());
 
-					// Prepare the parameters for the function call (DecorationData struct)
-					SpawnedFlora->ProcessEvent(SetDecorationDataFunc, (void*)&DecorationData);
-				}
-				else
-				{
-					// Log a warning if the function is not found
-					UE_LOG(LogTemp, Warning, TEXT("SetDecorationData function not found on %s"), *SpawnedFlora->GetName());
-				}
+				// Prepare the parameters for the function call (DecorationData struct)
+				SpawnedFlora->ProcessEvent(SetDecorationDataFunc, (void*)&DecorationData);
 			}
 			else
 			{
-				// Log an error if the flora couldn't be spawned
-				UE_LOG(LogTemp, Error, TEXT("Failed to spawn flora actor at %s"), *SpawnLocation.ToString());
+				// Log a warning if the function is not found
+				UE_LOG(LogTemp, Warning, TEXT("SetDecorationData function not found on %s"), *SpawnedFlora->GetName());
 			}
 		}
+		else
+		{
+			// Log an error if the flora couldn't be spawned
+			UE_LOG(LogTemp, Error, TEXT("Failed to spawn flora actor at %s"), *SpawnLocation.ToString());
+		}
 	}
 }
@@ -6,11 +6,18 @@
 #include "GameFramework/Actor.h"
 
 #include "Enums.h"
-#include "FastNoiseLite.h"
+#include "ChunkGenerationPipeline.h"
+#include "FeatureHash.h"
+#include "WaterSourceIndex.h"
 #include "ChunkWorld.generated.h"
 
 class AChunkBase; 
-class FastNoiseLite;
+class FChunkGenerator;
+class FChunkRegionStore;
+class FChunkColumn;
+class ANavMeshBoundsVolume;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnWorldVoxelsModified, const TArray<AChunkBase*>&, ModifiedChunks);
 
 UCLASS()
 class AChunkWorld final : public AActor
@@ -27,9 +34,19 @@ public:
     UPROPERTY(EditAnywhere, Category = "Flora")
     TSubclassOf<AActor> FloraBlueprint;
 
+    // Radius, in chunks around the player, inside which chunks are loaded
     UPROPERTY(EditInstanceOnly, Category = "World")
     int DrawDistance = 5;
 
+    // Extra chunks beyond DrawDistance a chunk may drift before it is unloaded, so walking
+    // back and forth over a chunk border does not reload the same chunks
+    UPROPERTY(EditInstanceOnly, Category = "World", meta = (ClampMin = "0"))
+    int UnloadMargin = 2;
+
+    // Chunk actors spawned and queued for generation per frame
+    UPROPERTY(EditInstanceOnly, Category = "World", meta = (ClampMin = "1"))
+    int MaxChunkLoadsPerFrame = 4;
+
     UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category = "Chunk")
     TObjectPtr<UMaterialInterface> LandMaterial;
 
@@ -39,11 +56,66 @@ public:
     UPROPERTY(EditInstanceOnly, Category = "Chunk")
     int ChunkSize = 32;
 
+    // Chunks stacked in every column, the world spans WorldHeightChunks * ChunkSize blocks from Z = 0
+    UPROPERTY(EditInstanceOnly, Category = "World", meta = (ClampMin = "1"))
+    int WorldHeightChunks = 2;
+
     int BlockSize = 100;
 
     UPROPERTY(EditInstanceOnly, Category = "Height Map")
     float Frequency = 0.03f;
 
+    // Surface height, in blocks, at the top of the height noise; the surface never rises above the world
+    UPROPERTY(EditInstanceOnly, Category = "Height Map", meta = (ClampMin = "0"))
+    int TerrainHeight = 32;
+
+    // How far below the surface caves reach. Chunks entirely below it are filled with stone without sampling noise
+    UPROPERTY(EditInstanceOnly, Category = "Height Map", meta = (ClampMin = "0"))
+    int CaveDepth = 32;
+
+    // Interpolated samples the cave noise every CaveLatticeStep voxels instead of at every voxel,
+    // the noise is smooth enough at the default frequency for the caves to keep their shape. Opt in,
+    // it moves some cave walls by a voxel so a seed no longer generates the same terrain as with Full
+    UPROPERTY(EditInstanceOnly, Category = "Height Map")
+    ECaveSampling CaveSampling = ECaveSampling::Full;
+
+    // Voxels between cave noise samples, keep ChunkSize a multiple of it so neighbouring chunks share samples
+    UPROPERTY(EditInstanceOnly, Category = "Height Map", meta = (ClampMin = "1", EditCondition = "CaveSampling == ECaveSampling::Interpolated"))
+    int CaveLatticeStep = 4;
+
+    // Worker threads used for chunk generation, 0 uses the logical core count minus two, at least one
+    UPROPERTY(EditInstanceOnly, Category = "Generation", meta = (ClampMin = "0"))
+    int GenerationWorkerCount = 0;
+
+    // Generated chunks whose meshes are uploaded on the game thread per frame
+    UPROPERTY(EditInstanceOnly, Category = "Generation", meta = (ClampMin = "1"))
+    int MaxMeshUploadsPerFrame = 4;
+
+    // Mesher used for every chunk, switch to compare timings and vertex counts on the same seed
+    UPROPERTY(EditInstanceOnly, Category = "Generation")
+    EChunkMesher Mesher = EChunkMesher::BinaryGreedy;
+
+    // Chunks remeshed per frame after a neighbour loaded or changed a voxel on their shared border
+    UPROPERTY(EditInstanceOnly, Category = "Generation", meta = (ClampMin = "1"))
+    int MaxBorderRemeshesPerFrame = 2;
+
+    // Seconds without voxel edits before their merged bounds are sent to the navigation system,
+    // so a burst of edits rebuilds each affected navmesh tile once. Edits pending for four times
+    // as long are flushed regardless
+    UPROPERTY(EditInstanceOnly, Category = "Navigation", meta = (ClampMin = "0"))
+    float NavigationUpdateDelay = 0.2f;
+
+    // Edited chunks are written to region files under Saved/Regions/<WorldSeed> after voxel edits,
+    // when they unload and when the world shuts down, and read back instead of being generated the
+    // next time they load
+    UPROPERTY(EditInstanceOnly, Category = "Persistence")
+    bool bSaveEdits = true;
+
+    // Seconds saves wait on the background save queue, a chunk saved again in the meantime is
+    // written once and a region with several saves is rewritten once
+    UPROPERTY(EditInstanceOnly, Category = "Persistence", meta = (ClampMin = "0"))
+    float SaveCoalesceDelay = 2.0f;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
     bool bShouldSpawnDeath;
     bool bShouldSpawnSheep;
@@ -53,33 +125,164 @@ public:
     // Sets default values for this actor's properties
     AChunkWorld();
 
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Number of chunks waiting for or running the given generation stage
+    UFUNCTION(BlueprintPure, Category = "Generation")
+    int32 GetGenerationQueueDepth(EChunkGenerationStage Stage) const;
+
+    // Chunk saves waiting for or being written to their region files
+    UFUNCTION(BlueprintPure, Category = "Persistence")
+    int32 GetSaveQueueDepth() const;
+
+    // World-space edits, routed to the loaded chunk containing each location. Like
+    // AChunkBase::ModifyVoxels every touched chunk is remeshed once at the end of the frame
+    UFUNCTION(BlueprintCallable, Category = "Chunk")
+    void ModifyVoxelAtLocation(const FVector& Location, EBlock Block);
+
+    // Locations and Blocks are paired by index
+    UFUNCTION(BlueprintCallable, Category = "Chunk")
+    void ModifyVoxelsAtLocations(const TArray<FVector>& Locations, const TArray<EBlock>& Blocks);
+
+    // Location of the water block closest to Location, false if no loaded chunk has water
+    UFUNCTION(BlueprintCallable, Category = "Water")
+    bool FindNearestWaterSource(const FVector& Location, FVector& OutWaterLocation) const;
+
+    // Distance to the closest water block, capped at MaxDistance
+    UFUNCTION(BlueprintCallable, Category = "Water")
+    float GetDistanceToWater(const FVector& Location, float MaxDistance = 1000.0f) const;
+
+    // Humidity of every block of a generated chunk, indexed like AChunkBase::GetBlockIndex
+    UFUNCTION(BlueprintCallable, Category = "Water")
+    void CalculateChunkHumidity(AChunkBase* Chunk, TArray<float>& OutHumidity) const;
+
+    // Broadcast at most once per frame with every chunk whose voxel edits were remeshed since the last one
+    UPROPERTY(BlueprintAssignable, Category = "Events")
+    FOnWorldVoxelsModified OnVoxelsModified;
+
 
 protected:
 
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
     int ChunkCount;
 
+    // Chunks handed to the pipeline that have not been uploaded yet
+    int PendingChunkCount = 0;
+    int GeneratedChunkCount = 0;
+
+    // Chunk the player was in when the load queue was last built
+    FIntVector StreamingCenter = FIntVector::ZeroValue;
+    bool bHasStreamingCenter = false;
+
+    // Missing chunks inside DrawDistance, farthest first so the nearest one is popped next
+    TArray<FIntVector> LoadQueue;
+
+    // Accumulated worker time spent per generation stage, in seconds
+    double DensitySeconds = 0.0;
+    double BiomeAssignmentSeconds = 0.0;
+    double DecorationSeconds = 0.0;
+    double MeshingSeconds = 0.0;
+
     void Generate3DWorld();
 
-    EBiome GetBiomeType(float NoiseValue, float Humidity) const;
+    // Loads and unloads chunks around the player, within the per-frame load budget
+    void UpdateStreaming();
+    FVector GetStreamingOrigin() const;
+    void RebuildLoadQueue();
+    void UnloadChunksOutOfRange();
 
-    void SetBiomeForChunk(AChunkBase* Chunk, int32 ChunkX, int32 ChunkY, int32 ChunkZ);
-    float CalculateHumidity(AChunkBase* Chunk, int32 bx, int32 by, int32 bz);
-    FVector GetNearestWaterSource(const FVector& Position);
+    void LoadChunk(const FIntVector& ChunkPosition);
+    void UnloadChunk(AChunkBase* Chunk);
 
-    void UpdateNavMeshBoundsVolume();
+    // Halo exchange between face neighbours, so chunk borders only mesh faces that can be seen
+    AChunkBase* FindGeneratedChunk(const FIntVector& ChunkPosition) const;
+    bool FillMissingHaloFaces(AChunkBase* Chunk) const;
+    void ConnectNeighbours(AChunkBase* Chunk);
+    void DisconnectNeighbours(AChunkBase* Chunk);
+    void ProcessBorderRemeshes();
+    void UpdateBorderFaceStats() const;
+
+    // Copies the border layers of Chunk into the halos of its generated neighbours, queueing a
+    // remesh of the ones whose halo changed
+    void RefreshNeighbourHalos(const AChunkBase* Chunk);
 
     UFUNCTION()
-    void OnChunkMeshUpdated();
+    void OnChunkVoxelsModified(AChunkBase* Chunk, const TArray<FIntVector>& Positions);
+
+    // Fires the aggregated edit event and the navigation update for the chunks edited last frame
+    void ProcessVoxelEdits();
+
+    // Returns a pooled chunk moved to ChunkPosition, spawning a new actor only when the pool is empty
+    AChunkBase* AcquireChunk(const FIntVector& ChunkPosition);
+    AChunkBase* SpawnChunk(const FIntVector& ChunkPosition);
+
+    // Uploads the meshes of up to MaxMeshUploadsPerFrame chunks finished by the pipeline
+    void ProcessGeneratedChunks();
+
+    float CalculateHumidity(AChunkBase* Chunk, int32 bx, int32 by, int32 bz) const;
+    FVector GetNearestWaterSource(const FVector& Position) const;
+
+    // Water blocks of the generated chunks, replaces scanning every chunk per query
+    TUniquePtr<FWaterSourceIndex> WaterSources;
+
+    // Moves the cached navmesh bounds volume around the player once streaming settles
+    void UpdateNavMeshBoundsVolume();
+
+    // Hands the merged dirty bounds of recent voxel edits to the navigation system once the
+    // edits have settled, only the navmesh tiles they overlap are rebuilt
+    void UpdateNavigationDirtyArea();
+
+    UPROPERTY()
+    TObjectPtr<ANavMeshBoundsVolume> NavMeshBoundsVolume;
+
+    void GenerateFlora(AChunkBase* Chunk);
+
+    TMap<FIntVector, AChunkBase*> Chunks;
+
+    // Loaded chunk columns, handed to every chunk stacked in them to share the surface prepass
+    TMap<FIntPoint, TSharedPtr<FChunkColumn>> Columns;
+    TSharedRef<FChunkColumn> GetColumn(const FIntPoint& Column);
+
+    // Generated chunks waiting for a remesh against their updated halo
+    TSet<FIntVector> BorderRemeshQueue;
+
+    // Tree voxels reaching past the chunk they are rooted in, keyed by the chunk they fall in and then
+    // by the loaded chunk they came from. Placed when the target chunk generates, or right away if it
+    // already has, and dropped with the source chunk when it unloads
+    TMap<FIntVector, TMap<FIntVector, TArray<FFeatureBlock>>> PendingFeatureBlocks;
+
+    // Places the pending tree voxels that fall in ChunkData and it was not handed yet, returns false
+    // if nothing changed
+    bool ApplyPendingFeatureBlocks(FChunkData& ChunkData) const;
+
+    // Hands the tree voxels Chunk generated past its bounds to the chunks they fall in
+    void DistributeFeatureBlocks(AChunkBase* Chunk);
+
+    // Chunks that flushed voxel edits since the last ProcessVoxelEdits
+    TArray<AChunkBase*> ModifiedChunks;
+
+    // Union of the voxel edits not yet sent to the navigation system, and when they were made
+    FBox PendingNavigationBounds = FBox(ForceInit);
+    double FirstNavigationEditTime = 0.0;
+    double LastNavigationEditTime = 0.0;
+
+    // Unloaded chunk actors kept hidden for reuse
+    TArray<AChunkBase*> ChunkPool;
+    int PoolHits = 0;
+    int PoolMisses = 0;
 
-    void GenerateFlora();
+    TSharedPtr<FChunkGenerator> Generator;
+    TUniquePtr<FChunkGenerationPipeline> Pipeline;
 
-    TArray<AChunkBase*> Chunks;
+    // Null when bSaveEdits is off
+    TUniquePtr<FChunkRegionStore> RegionStore;
 
-    TUniquePtr<FastNoiseLite> BiomeNoise;
-    TUniquePtr<FastNoiseLite> HumidityNoise;
+    // Queues a save of every loaded chunk with edits that are not in its region file yet
+    void SaveEditedChunks();
 
 };
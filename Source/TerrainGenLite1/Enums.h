@@ -31,3 +31,40 @@ enum class EBlockCategory : uint8
     Liquid,
     NonSolid
 };
+
+// Stages a chunk passes through in the generation pipeline
+UENUM(BlueprintType)
+enum class EChunkGenerationStage : uint8
+{
+    Density,
+    Biome,
+    Decoration,
+    Meshing,
+    Upload,
+    Num UMETA(Hidden)
+};
+
+// Greedy meshing implementation used by FChunkData::GenerateMesh, both produce the same quads
+UENUM(BlueprintType)
+enum class EChunkMesher : uint8
+{
+    Greedy,         // Compares the mask one cell at a time
+    BinaryGreedy    // Merges faces with per-column bitmasks
+};
+
+// What a generated chunk is made of, uniform chunks store a single block and skip most of the work
+UENUM(BlueprintType)
+enum class EChunkContents : uint8
+{
+    Empty,          // Only air, never meshed
+    Solid,          // One opaque block, only meshed where a neighbour exposes its faces
+    Mixed
+};
+
+// How FChunkGenerator samples the 3D noise that carves caves
+UENUM(BlueprintType)
+enum class ECaveSampling : uint8
+{
+    Full,           // Evaluates the noise at every voxel
+    Interpolated    // Evaluates it on a coarse lattice and interpolates trilinearly inside the cells
+};
@@ -394,6 +394,9 @@ public:
     }
 
 private:
+    // Batched grid evaluation (NoiseBatch.h) reads the settings and lookup tables directly
+    friend class FNoiseBatch;
+
     template <typename T>
     struct Arguments_must_be_floating_point_values;
 
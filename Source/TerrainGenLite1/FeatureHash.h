@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums.h"
+
+// Decorations rolled per block, each one draws from its own hash stream
+enum class EDecorationFeature : uint32
+{
+	Tree,
+	Flora
+};
+
+// Voxel of a tree that reaches past the chunk it is rooted in, Position is local to the chunk it falls in
+struct FFeatureBlock
+{
+	FIntVector Position;
+	EBlock Block;
+};
+
+/**
+ * Stateless hash of (world seed, world block coordinate, feature) for decoration placement.
+ *
+ * The same block of the same seed always rolls the same value whatever chunk, thread or order it
+ * is generated in, so a chunk generated again after unloading gets back the trees and flora it had
+ * and only edited chunks need saving. Safe to call from any thread.
+ */
+struct FFeatureHash
+{
+	static uint32 Hash(const int32 WorldSeed, const FIntVector& WorldBlock, const EDecorationFeature Feature)
+	{
+		uint64 Value = Mix((uint64(uint32(WorldSeed)) << 32) | static_cast<uint32>(Feature));
+		Value = Mix(Value ^ uint32(WorldBlock.X));
+		Value = Mix(Value ^ uint32(WorldBlock.Y));
+		Value = Mix(Value ^ uint32(WorldBlock.Z));
+		return uint32(Value >> 32);
+	}
+
+	// Uniform in [0, Range)
+	static int32 Roll(const int32 WorldSeed, const FIntVector& WorldBlock, const EDecorationFeature Feature, const int32 Range)
+	{
+		return int32((uint64(Hash(WorldSeed, WorldBlock, Feature)) * uint32(Range)) >> 32);
+	}
+
+private:
+	// SplitMix64 finalizer, every input bit affects every output bit
+	static uint64 Mix(uint64 Value)
+	{
+		Value += 0x9E3779B97F4A7C15ull;
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+};
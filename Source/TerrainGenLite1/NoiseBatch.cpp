@@ -0,0 +1,424 @@
+#include "NoiseBatch.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+#define NOISE_BATCH_SIMD (PLATFORM_CPU_X86_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS)
+
+#if NOISE_BATCH_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Plain copy of the FastNoiseLite settings the kernels read, so they do not need to be friends
+struct FNoiseBatchSettings
+{
+	FastNoiseLite::NoiseType NoiseType;
+	FastNoiseLite::CellularDistanceFunction CellularDistanceFunction;
+	FastNoiseLite::CellularReturnType CellularReturnType;
+
+	int32 Seed;
+	float Frequency;
+	int32 Octaves;
+	float Lacunarity;
+	float Gain;
+	float WeightedStrength;
+	float FractalBounding;
+	float CellularJitter;
+
+	const float* Gradients2D;
+	const float* Gradients3D;
+	const float* RandVecs2D;
+};
+
+#if NOISE_BATCH_SIMD
+
+// The lane types and kernels of each instruction set are compiled for it alone, clang and gcc need
+// the target on every function using its intrinsics while msvc accepts them anywhere
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+namespace NoiseBatchSSE41
+{
+	struct FLanes
+	{
+		static constexpr int32 Width = 4;
+
+		using FFloat = __m128;
+		using FInt = __m128i;
+
+		static FORCEINLINE FFloat Set(const float Value) { return _mm_set1_ps(Value); }
+		static FORCEINLINE FInt SetInt(const int32 Value) { return _mm_set1_epi32(Value); }
+		static FORCEINLINE FInt Ramp() { return _mm_setr_epi32(0, 1, 2, 3); }
+		static FORCEINLINE void Store(float* Out, const FFloat Value) { _mm_storeu_ps(Out, Value); }
+
+		static FORCEINLINE FFloat Add(const FFloat A, const FFloat B) { return _mm_add_ps(A, B); }
+		static FORCEINLINE FFloat Sub(const FFloat A, const FFloat B) { return _mm_sub_ps(A, B); }
+		static FORCEINLINE FFloat Mul(const FFloat A, const FFloat B) { return _mm_mul_ps(A, B); }
+		static FORCEINLINE FFloat Div(const FFloat A, const FFloat B) { return _mm_div_ps(A, B); }
+		static FORCEINLINE FFloat Min(const FFloat A, const FFloat B) { return _mm_min_ps(A, B); }
+		static FORCEINLINE FFloat Max(const FFloat A, const FFloat B) { return _mm_max_ps(A, B); }
+		static FORCEINLINE FFloat Sqrt(const FFloat A) { return _mm_sqrt_ps(A); }
+		static FORCEINLINE FFloat Abs(const FFloat A) { return _mm_and_ps(A, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+		static FORCEINLINE FFloat Less(const FFloat A, const FFloat B) { return _mm_cmplt_ps(A, B); }
+		static FORCEINLINE FFloat Select(const FFloat Mask, const FFloat A, const FFloat B) { return _mm_blendv_ps(B, A, Mask); }
+
+		static FORCEINLINE FInt AddInt(const FInt A, const FInt B) { return _mm_add_epi32(A, B); }
+		static FORCEINLINE FInt MulInt(const FInt A, const FInt B) { return _mm_mullo_epi32(A, B); }
+		static FORCEINLINE FInt Xor(const FInt A, const FInt B) { return _mm_xor_si128(A, B); }
+		static FORCEINLINE FInt And(const FInt A, const FInt B) { return _mm_and_si128(A, B); }
+		static FORCEINLINE FInt Or(const FInt A, const FInt B) { return _mm_or_si128(A, B); }
+		template <int32 Bits>
+		static FORCEINLINE FInt ShiftRight(const FInt A) { return _mm_srai_epi32(A, Bits); }
+		static FORCEINLINE FInt SelectInt(const FFloat Mask, const FInt A, const FInt B) { return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(B), _mm_castsi128_ps(A), Mask)); }
+
+		static FORCEINLINE FFloat ToFloat(const FInt A) { return _mm_cvtepi32_ps(A); }
+		static FORCEINLINE FInt Trunc(const FFloat A) { return _mm_cvttps_epi32(A); }
+		static FORCEINLINE FInt MaskToInt(const FFloat Mask) { return _mm_castps_si128(Mask); }
+
+		// No gather before AVX2, the lanes are read one by one
+		static FORCEINLINE FFloat Gather(const float* Table, const FInt Index)
+		{
+			alignas(16) int32 Indices[Width];
+			_mm_store_si128(reinterpret_cast<__m128i*>(Indices), Index);
+			return _mm_setr_ps(Table[Indices[0]], Table[Indices[1]], Table[Indices[2]], Table[Indices[3]]);
+		}
+	};
+
+#include "NoiseBatchKernels.inl"
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace NoiseBatchAVX2
+{
+	struct FLanes
+	{
+		static constexpr int32 Width = 8;
+
+		using FFloat = __m256;
+		using FInt = __m256i;
+
+		static FORCEINLINE FFloat Set(const float Value) { return _mm256_set1_ps(Value); }
+		static FORCEINLINE FInt SetInt(const int32 Value) { return _mm256_set1_epi32(Value); }
+		static FORCEINLINE FInt Ramp() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+		static FORCEINLINE void Store(float* Out, const FFloat Value) { _mm256_storeu_ps(Out, Value); }
+
+		static FORCEINLINE FFloat Add(const FFloat A, const FFloat B) { return _mm256_add_ps(A, B); }
+		static FORCEINLINE FFloat Sub(const FFloat A, const FFloat B) { return _mm256_sub_ps(A, B); }
+		static FORCEINLINE FFloat Mul(const FFloat A, const FFloat B) { return _mm256_mul_ps(A, B); }
+		static FORCEINLINE FFloat Div(const FFloat A, const FFloat B) { return _mm256_div_ps(A, B); }
+		static FORCEINLINE FFloat Min(const FFloat A, const FFloat B) { return _mm256_min_ps(A, B); }
+		static FORCEINLINE FFloat Max(const FFloat A, const FFloat B) { return _mm256_max_ps(A, B); }
+		static FORCEINLINE FFloat Sqrt(const FFloat A) { return _mm256_sqrt_ps(A); }
+		static FORCEINLINE FFloat Abs(const FFloat A) { return _mm256_and_ps(A, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+		static FORCEINLINE FFloat Less(const FFloat A, const FFloat B) { return _mm256_cmp_ps(A, B, _CMP_LT_OQ); }
+		static FORCEINLINE FFloat Select(const FFloat Mask, const FFloat A, const FFloat B) { return _mm256_blendv_ps(B, A, Mask); }
+
+		static FORCEINLINE FInt AddInt(const FInt A, const FInt B) { return _mm256_add_epi32(A, B); }
+		static FORCEINLINE FInt MulInt(const FInt A, const FInt B) { return _mm256_mullo_epi32(A, B); }
+		static FORCEINLINE FInt Xor(const FInt A, const FInt B) { return _mm256_xor_si256(A, B); }
+		static FORCEINLINE FInt And(const FInt A, const FInt B) { return _mm256_and_si256(A, B); }
+		static FORCEINLINE FInt Or(const FInt A, const FInt B) { return _mm256_or_si256(A, B); }
+		template <int32 Bits>
+		static FORCEINLINE FInt ShiftRight(const FInt A) { return _mm256_srai_epi32(A, Bits); }
+		static FORCEINLINE FInt SelectInt(const FFloat Mask, const FInt A, const FInt B) { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(B), _mm256_castsi256_ps(A), Mask)); }
+
+		static FORCEINLINE FFloat ToFloat(const FInt A) { return _mm256_cvtepi32_ps(A); }
+		static FORCEINLINE FInt Trunc(const FFloat A) { return _mm256_cvttps_epi32(A); }
+		static FORCEINLINE FInt MaskToInt(const FFloat Mask) { return _mm256_castps_si256(Mask); }
+
+		static FORCEINLINE FFloat Gather(const float* Table, const FInt Index) { return _mm256_i32gather_ps(Table, Index, 4); }
+	};
+
+#include "NoiseBatchKernels.inl"
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace
+{
+	void Cpuid(int32 (&OutRegisters)[4], const int32 Leaf)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		__cpuidex(OutRegisters, Leaf, 0);
+#else
+		uint32 A, B, C, D;
+		__cpuid_count(Leaf, 0, A, B, C, D);
+		OutRegisters[0] = A;
+		OutRegisters[1] = B;
+		OutRegisters[2] = C;
+		OutRegisters[3] = D;
+#endif
+	}
+
+	// Register state the OS saves on context switches, AVX needs the SSE and YMM bits
+	uint64 ReadXCR0()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		return _xgetbv(0);
+#else
+		uint32 Low, High;
+		__asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+		return (uint64(High) << 32) | Low;
+#endif
+	}
+
+	FNoiseBatch::EPath DetectBestPath()
+	{
+		int32 Registers[4];
+		Cpuid(Registers, 0);
+		const int32 MaxLeaf = Registers[0];
+
+		Cpuid(Registers, 1);
+		const bool bHasSSE41 = (Registers[2] & (1 << 19)) != 0;
+		const bool bHasOSXSave = (Registers[2] & (1 << 27)) != 0;
+		const bool bHasAVX = (Registers[2] & (1 << 28)) != 0;
+
+		if (MaxLeaf >= 7 && bHasOSXSave && bHasAVX && (ReadXCR0() & 0x6) == 0x6)
+		{
+			Cpuid(Registers, 7);
+			if ((Registers[1] & (1 << 5)) != 0)
+			{
+				return FNoiseBatch::EPath::AVX2;
+			}
+		}
+
+		return bHasSSE41 ? FNoiseBatch::EPath::SSE41 : FNoiseBatch::EPath::Scalar;
+	}
+}
+
+#endif // NOISE_BATCH_SIMD
+
+FNoiseBatch::EPath FNoiseBatch::GetBestPath()
+{
+#if NOISE_BATCH_SIMD
+	static const EPath BestPath = DetectBestPath();
+	return BestPath;
+#else
+	return EPath::Scalar;
+#endif
+}
+
+const TCHAR* FNoiseBatch::GetPathName(const EPath Path)
+{
+	switch (Path)
+	{
+	case EPath::SSE41:
+		return TEXT("SSE4.1");
+	case EPath::AVX2:
+		return TEXT("AVX2");
+	default:
+		return TEXT("Scalar");
+	}
+}
+
+bool FNoiseBatch::GetSettings(const FastNoiseLite& Noise, const bool bIs3D, FNoiseBatchSettings& OutSettings)
+{
+	// Only Perlin has a 3D kernel, and only without the rotation OpenSimplex2 style transforms add
+	const bool bHasKernel = bIs3D
+		? Noise.mNoiseType == FastNoiseLite::NoiseType_Perlin && Noise.mTransformType3D == FastNoiseLite::TransformType3D_None
+		: Noise.mNoiseType == FastNoiseLite::NoiseType_Perlin || Noise.mNoiseType == FastNoiseLite::NoiseType_Cellular;
+
+	// Ridged and ping pong keep the scalar path, domain warp types only affect DomainWarp
+	const bool bIsFBm = Noise.mFractalType == FastNoiseLite::FractalType_FBm;
+	if (!bHasKernel || Noise.mFractalType == FastNoiseLite::FractalType_Ridged || Noise.mFractalType == FastNoiseLite::FractalType_PingPong)
+	{
+		return false;
+	}
+
+	OutSettings.NoiseType = Noise.mNoiseType;
+	OutSettings.CellularDistanceFunction = Noise.mCellularDistanceFunction;
+	OutSettings.CellularReturnType = Noise.mCellularReturnType;
+
+	OutSettings.Seed = Noise.mSeed;
+	OutSettings.Frequency = Noise.mFrequency;
+	OutSettings.Octaves = bIsFBm ? Noise.mOctaves : 1;
+	OutSettings.Lacunarity = Noise.mLacunarity;
+	OutSettings.Gain = Noise.mGain;
+	OutSettings.WeightedStrength = Noise.mWeightedStrength;
+	OutSettings.FractalBounding = bIsFBm ? Noise.mFractalBounding : 1.0f;
+	OutSettings.CellularJitter = 0.43701595f * Noise.mCellularJitterModifier;
+
+	OutSettings.Gradients2D = FastNoiseLite::Lookup<float>::Gradients2D;
+	OutSettings.Gradients3D = FastNoiseLite::Lookup<float>::Gradients3D;
+	OutSettings.RandVecs2D = FastNoiseLite::Lookup<float>::RandVecs2D;
+	return true;
+}
+
+bool FNoiseBatch::IsVectorized(const FastNoiseLite& Noise, const bool bIs3D)
+{
+	FNoiseBatchSettings Settings;
+	return GetBestPath() != EPath::Scalar && GetSettings(Noise, bIs3D, Settings);
+}
+
+void FNoiseBatch::GenerateGrid2D(const FastNoiseLite& Noise, float* Out, const int32 SizeX, const int32 SizeY,
+	const float X0, const float Y0, const float Step, EPath Path)
+{
+	FNoiseBatchSettings Settings;
+	if (!GetSettings(Noise, false, Settings) || Path > GetBestPath())
+	{
+		Path = EPath::Scalar;
+	}
+
+#if NOISE_BATCH_SIMD
+	if (Path == EPath::AVX2)
+	{
+		NoiseBatchAVX2::GenerateGrid2D(Settings, Out, SizeX, SizeY, X0, Y0, Step);
+		return;
+	}
+	if (Path == EPath::SSE41)
+	{
+		NoiseBatchSSE41::GenerateGrid2D(Settings, Out, SizeX, SizeY, X0, Y0, Step);
+		return;
+	}
+#endif
+
+	for (int32 Y = 0; Y < SizeY; ++Y)
+	{
+		for (int32 X = 0; X < SizeX; ++X)
+		{
+			*Out++ = Noise.GetNoise(X0 + X * Step, Y0 + Y * Step);
+		}
+	}
+}
+
+void FNoiseBatch::GenerateGrid3D(const FastNoiseLite& Noise, float* Out, const int32 SizeX, const int32 SizeY, const int32 SizeZ,
+	const float X0, const float Y0, const float Z0, const float Step, EPath Path)
+{
+	FNoiseBatchSettings Settings;
+	if (!GetSettings(Noise, true, Settings) || Path > GetBestPath())
+	{
+		Path = EPath::Scalar;
+	}
+
+#if NOISE_BATCH_SIMD
+	if (Path == EPath::AVX2)
+	{
+		NoiseBatchAVX2::GenerateGrid3D(Settings, Out, SizeX, SizeY, SizeZ, X0, Y0, Z0, Step);
+		return;
+	}
+	if (Path == EPath::SSE41)
+	{
+		NoiseBatchSSE41::GenerateGrid3D(Settings, Out, SizeX, SizeY, SizeZ, X0, Y0, Z0, Step);
+		return;
+	}
+#endif
+
+	for (int32 Z = 0; Z < SizeZ; ++Z)
+	{
+		for (int32 Y = 0; Y < SizeY; ++Y)
+		{
+			for (int32 X = 0; X < SizeX; ++X)
+			{
+				*Out++ = Noise.GetNoise(X0 + X * Step, Y0 + Y * Step, Z0 + Z * Step);
+			}
+		}
+	}
+}
+
+void FNoiseBatch::RunBenchmark(const int32 GridSize, const int32 Iterations)
+{
+	struct FBenchmarkNoise
+	{
+		const TCHAR* Name;
+		FastNoiseLite::NoiseType NoiseType;
+	};
+	const FBenchmarkNoise NoiseTypes[] = {
+		{ TEXT("Perlin"), FastNoiseLite::NoiseType_Perlin },
+		{ TEXT("OpenSimplex2"), FastNoiseLite::NoiseType_OpenSimplex2 },
+		{ TEXT("Cellular"), FastNoiseLite::NoiseType_Cellular },
+	};
+
+	const int32 NumPoints = GridSize * GridSize * GridSize;
+	TArray<float> Reference;
+	TArray<float> Result;
+	Reference.SetNumUninitialized(NumPoints);
+	Result.SetNumUninitialized(NumPoints);
+
+	UE_LOG(LogTemp, Log, TEXT("Noise benchmark: %d^3 points x %d grids, best path %s"), GridSize, Iterations, GetPathName(GetBestPath()));
+
+	for (const FBenchmarkNoise& Type : NoiseTypes)
+	{
+		// Same fractal settings as the terrain noise
+		FastNoiseLite Noise(1337);
+		Noise.SetFrequency(0.03f);
+		Noise.SetNoiseType(Type.NoiseType);
+		Noise.SetFractalType(FastNoiseLite::FractalType_FBm);
+
+		for (const bool bIs3D : { false, true })
+		{
+			double ScalarRate = 0;
+
+			for (int32 PathIndex = 0; PathIndex <= static_cast<int32>(GetBestPath()); ++PathIndex)
+			{
+				const EPath Path = static_cast<EPath>(PathIndex);
+				float* Out = Path == EPath::Scalar ? Reference.GetData() : Result.GetData();
+
+				// 2D grids are GridSize by GridSize^2 so both time the same number of points
+				const double StartTime = FPlatformTime::Seconds();
+				for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					const float Origin = static_cast<float>(Iteration * GridSize);
+					if (bIs3D)
+					{
+						GenerateGrid3D(Noise, Out, GridSize, GridSize, GridSize, Origin, -Origin, Origin * 0.5f, 1.0f, Path);
+					}
+					else
+					{
+						GenerateGrid2D(Noise, Out, GridSize, GridSize * GridSize, Origin, -Origin, 1.0f, Path);
+					}
+				}
+				const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, SMALL_NUMBER);
+				const double Rate = double(NumPoints) * Iterations / Seconds;
+
+				if (Path == EPath::Scalar)
+				{
+					ScalarRate = Rate;
+					UE_LOG(LogTemp, Log, TEXT("  %-12s %s %-7s %8.2f M points/s"), Type.Name, bIs3D ? TEXT("3D") : TEXT("2D"), GetPathName(Path), Rate / 1e6);
+					continue;
+				}
+
+				// Both buffers hold the last grid
+				float MaxError = 0.0f;
+				for (int32 i = 0; i < NumPoints; ++i)
+				{
+					MaxError = FMath::Max(MaxError, FMath::Abs(Result[i] - Reference[i]));
+				}
+
+				UE_LOG(LogTemp, Log, TEXT("  %-12s %s %-7s %8.2f M points/s  %5.2fx  max error %g%s"), Type.Name, bIs3D ? TEXT("3D") : TEXT("2D"), GetPathName(Path),
+					Rate / 1e6, Rate / ScalarRate, MaxError, IsVectorized(Noise, bIs3D) ? TEXT("") : TEXT("  (scalar fallback)"));
+			}
+		}
+	}
+}
+
+static FAutoConsoleCommand NoiseBenchmarkCommand(
+	TEXT("Voxel.NoiseBenchmark"),
+	TEXT("Times batched noise against GetNoise per point for Perlin, OpenSimplex2 and Cellular. Args: [GridSize=32] [Iterations=32]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 GridSize = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 256) : 32;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 32;
+		FNoiseBatch::RunBenchmark(GridSize, Iterations);
+	}));
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FastNoiseLite.h"
+
+struct FNoiseBatchSettings;
+
+/**
+ * Fills whole grids of FastNoiseLite samples instead of calling GetNoise once per point.
+ *
+ * Perlin (2D and 3D) and 2D Cellular with no fractal or FBm are evaluated several points at a
+ * time in SSE4.1 or AVX2 lanes, picked at runtime from what the CPU supports. The lanes run the
+ * same float operations in the same order as the scalar code, so they match GetNoise called with
+ * float coordinates. Every other setting falls back to GetNoise per point.
+ *
+ * Grid points are Origin + Index * Step on each axis and are written X fastest, matching
+ * FChunkData::GetBlockIndex for a chunk sized grid. Safe to call from any thread.
+ */
+class FNoiseBatch
+{
+public:
+	enum class EPath : uint8
+	{
+		Scalar,
+		SSE41,
+		AVX2
+	};
+
+	// Widest path the running CPU supports, detected once
+	static EPath GetBestPath();
+
+	static const TCHAR* GetPathName(EPath Path);
+
+	// True if the settings of Noise have a vectorized kernel
+	static bool IsVectorized(const FastNoiseLite& Noise, bool bIs3D);
+
+	// Out[Y * SizeX + X] = Noise.GetNoise(X0 + X * Step, Y0 + Y * Step)
+	static void GenerateGrid2D(const FastNoiseLite& Noise, float* Out, int32 SizeX, int32 SizeY,
+		float X0, float Y0, float Step = 1.0f, EPath Path = GetBestPath());
+
+	// Out[(Z * SizeY + Y) * SizeX + X] = Noise.GetNoise(X0 + X * Step, Y0 + Y * Step, Z0 + Z * Step)
+	static void GenerateGrid3D(const FastNoiseLite& Noise, float* Out, int32 SizeX, int32 SizeY, int32 SizeZ,
+		float X0, float Y0, float Z0, float Step = 1.0f, EPath Path = GetBestPath());
+
+	// Logs points per second of each path for Perlin, OpenSimplex2 and Cellular, and how far the
+	// vectorized results are from the scalar ones. Bound to the "Voxel.NoiseBenchmark" console command
+	static void RunBenchmark(int32 GridSize, int32 Iterations);
+
+private:
+	// Copies what the kernels need out of Noise, returns false if there is no kernel for it
+	static bool GetSettings(const FastNoiseLite& Noise, bool bIs3D, FNoiseBatchSettings& OutSettings);
+};
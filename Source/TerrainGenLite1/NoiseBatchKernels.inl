@@ -0,0 +1,332 @@
+// Vectorized FastNoiseLite kernels, included by NoiseBatch.cpp once per instruction set inside
+// that instruction set's namespace and target region, with FLanes naming its lane type.
+//
+// Each function mirrors the FastNoiseLite function of the same name operation for operation, so
+// changing the order of any arithmetic here makes the results drift from GetNoise.
+
+using FFloat = FLanes::FFloat;
+using FInt = FLanes::FInt;
+
+static constexpr int32 PrimeX = 501125321;
+static constexpr int32 PrimeY = 1136930381;
+static constexpr int32 PrimeZ = 1720413743;
+
+FORCEINLINE FInt FastFloor(const FFloat F)
+{
+	// Truncates, then steps negative values down by adding the all ones compare mask
+	return FLanes::AddInt(FLanes::Trunc(F), FLanes::MaskToInt(FLanes::Less(F, FLanes::Set(0.0f))));
+}
+
+FORCEINLINE FInt FastRound(const FFloat F)
+{
+	return FLanes::Trunc(FLanes::Add(F, FLanes::Select(FLanes::Less(F, FLanes::Set(0.0f)), FLanes::Set(-0.5f), FLanes::Set(0.5f))));
+}
+
+FORCEINLINE FFloat Lerp(const FFloat A, const FFloat B, const FFloat T)
+{
+	return FLanes::Add(A, FLanes::Mul(T, FLanes::Sub(B, A)));
+}
+
+FORCEINLINE FFloat InterpQuintic(const FFloat T)
+{
+	const FFloat T3 = FLanes::Mul(FLanes::Mul(T, T), T);
+	return FLanes::Mul(T3, FLanes::Add(FLanes::Mul(T, FLanes::Sub(FLanes::Mul(T, FLanes::Set(6.0f)), FLanes::Set(15.0f))), FLanes::Set(10.0f)));
+}
+
+FORCEINLINE FInt Hash(const FInt Seed, const FInt XPrimed, const FInt YPrimed)
+{
+	return FLanes::MulInt(FLanes::Xor(FLanes::Xor(Seed, XPrimed), YPrimed), FLanes::SetInt(0x27d4eb2d));
+}
+
+FORCEINLINE FInt Hash(const FInt Seed, const FInt XPrimed, const FInt YPrimed, const FInt ZPrimed)
+{
+	return FLanes::MulInt(FLanes::Xor(FLanes::Xor(FLanes::Xor(Seed, XPrimed), YPrimed), ZPrimed), FLanes::SetInt(0x27d4eb2d));
+}
+
+FORCEINLINE FFloat GradCoord(const FNoiseBatchSettings& Settings, const FInt Seed, const FInt XPrimed, const FInt YPrimed,
+	const FFloat XD, const FFloat YD)
+{
+	FInt HashValue = Hash(Seed, XPrimed, YPrimed);
+	HashValue = FLanes::Xor(HashValue, FLanes::ShiftRight<15>(HashValue));
+	HashValue = FLanes::And(HashValue, FLanes::SetInt(127 << 1));
+
+	const FFloat XG = FLanes::Gather(Settings.Gradients2D, HashValue);
+	const FFloat YG = FLanes::Gather(Settings.Gradients2D, FLanes::Or(HashValue, FLanes::SetInt(1)));
+
+	return FLanes::Add(FLanes::Mul(XD, XG), FLanes::Mul(YD, YG));
+}
+
+FORCEINLINE FFloat GradCoord(const FNoiseBatchSettings& Settings, const FInt Seed, const FInt XPrimed, const FInt YPrimed, const FInt ZPrimed,
+	const FFloat XD, const FFloat YD, const FFloat ZD)
+{
+	FInt HashValue = Hash(Seed, XPrimed, YPrimed, ZPrimed);
+	HashValue = FLanes::Xor(HashValue, FLanes::ShiftRight<15>(HashValue));
+	HashValue = FLanes::And(HashValue, FLanes::SetInt(63 << 2));
+
+	const FFloat XG = FLanes::Gather(Settings.Gradients3D, HashValue);
+	const FFloat YG = FLanes::Gather(Settings.Gradients3D, FLanes::Or(HashValue, FLanes::SetInt(1)));
+	const FFloat ZG = FLanes::Gather(Settings.Gradients3D, FLanes::Or(HashValue, FLanes::SetInt(2)));
+
+	return FLanes::Add(FLanes::Add(FLanes::Mul(XD, XG), FLanes::Mul(YD, YG)), FLanes::Mul(ZD, ZG));
+}
+
+FORCEINLINE FFloat SinglePerlin(const FNoiseBatchSettings& Settings, const FInt Seed, const FFloat X, const FFloat Y)
+{
+	FInt X0 = FastFloor(X);
+	FInt Y0 = FastFloor(Y);
+
+	const FFloat XD0 = FLanes::Sub(X, FLanes::ToFloat(X0));
+	const FFloat YD0 = FLanes::Sub(Y, FLanes::ToFloat(Y0));
+	const FFloat XD1 = FLanes::Sub(XD0, FLanes::Set(1.0f));
+	const FFloat YD1 = FLanes::Sub(YD0, FLanes::Set(1.0f));
+
+	const FFloat XS = InterpQuintic(XD0);
+	const FFloat YS = InterpQuintic(YD0);
+
+	X0 = FLanes::MulInt(X0, FLanes::SetInt(PrimeX));
+	Y0 = FLanes::MulInt(Y0, FLanes::SetInt(PrimeY));
+	const FInt X1 = FLanes::AddInt(X0, FLanes::SetInt(PrimeX));
+	const FInt Y1 = FLanes::AddInt(Y0, FLanes::SetInt(PrimeY));
+
+	const FFloat XF0 = Lerp(GradCoord(Settings, Seed, X0, Y0, XD0, YD0), GradCoord(Settings, Seed, X1, Y0, XD1, YD0), XS);
+	const FFloat XF1 = Lerp(GradCoord(Settings, Seed, X0, Y1, XD0, YD1), GradCoord(Settings, Seed, X1, Y1, XD1, YD1), XS);
+
+	return FLanes::Mul(Lerp(XF0, XF1, YS), FLanes::Set(1.4247691104677813f));
+}
+
+FORCEINLINE FFloat SinglePerlin(const FNoiseBatchSettings& Settings, const FInt Seed, const FFloat X, const FFloat Y, const FFloat Z)
+{
+	FInt X0 = FastFloor(X);
+	FInt Y0 = FastFloor(Y);
+	FInt Z0 = FastFloor(Z);
+
+	const FFloat XD0 = FLanes::Sub(X, FLanes::ToFloat(X0));
+	const FFloat YD0 = FLanes::Sub(Y, FLanes::ToFloat(Y0));
+	const FFloat ZD0 = FLanes::Sub(Z, FLanes::ToFloat(Z0));
+	const FFloat XD1 = FLanes::Sub(XD0, FLanes::Set(1.0f));
+	const FFloat YD1 = FLanes::Sub(YD0, FLanes::Set(1.0f));
+	const FFloat ZD1 = FLanes::Sub(ZD0, FLanes::Set(1.0f));
+
+	const FFloat XS = InterpQuintic(XD0);
+	const FFloat YS = InterpQuintic(YD0);
+	const FFloat ZS = InterpQuintic(ZD0);
+
+	X0 = FLanes::MulInt(X0, FLanes::SetInt(PrimeX));
+	Y0 = FLanes::MulInt(Y0, FLanes::SetInt(PrimeY));
+	Z0 = FLanes::MulInt(Z0, FLanes::SetInt(PrimeZ));
+	const FInt X1 = FLanes::AddInt(X0, FLanes::SetInt(PrimeX));
+	const FInt Y1 = FLanes::AddInt(Y0, FLanes::SetInt(PrimeY));
+	const FInt Z1 = FLanes::AddInt(Z0, FLanes::SetInt(PrimeZ));
+
+	const FFloat XF00 = Lerp(GradCoord(Settings, Seed, X0, Y0, Z0, XD0, YD0, ZD0), GradCoord(Settings, Seed, X1, Y0, Z0, XD1, YD0, ZD0), XS);
+	const FFloat XF10 = Lerp(GradCoord(Settings, Seed, X0, Y1, Z0, XD0, YD1, ZD0), GradCoord(Settings, Seed, X1, Y1, Z0, XD1, YD1, ZD0), XS);
+	const FFloat XF01 = Lerp(GradCoord(Settings, Seed, X0, Y0, Z1, XD0, YD0, ZD1), GradCoord(Settings, Seed, X1, Y0, Z1, XD1, YD0, ZD1), XS);
+	const FFloat XF11 = Lerp(GradCoord(Settings, Seed, X0, Y1, Z1, XD0, YD1, ZD1), GradCoord(Settings, Seed, X1, Y1, Z1, XD1, YD1, ZD1), XS);
+
+	const FFloat YF0 = Lerp(XF00, XF10, YS);
+	const FFloat YF1 = Lerp(XF01, XF11, YS);
+
+	return FLanes::Mul(Lerp(YF0, YF1, ZS), FLanes::Set(0.964921414852142333984375f));
+}
+
+FORCEINLINE FFloat SingleCellular(const FNoiseBatchSettings& Settings, const FInt Seed, const FFloat X, const FFloat Y)
+{
+	const FInt XR = FastRound(X);
+	const FInt YR = FastRound(Y);
+
+	FFloat Distance0 = FLanes::Set(1e10f);
+	FFloat Distance1 = FLanes::Set(1e10f);
+	FInt ClosestHash = FLanes::SetInt(0);
+
+	const FFloat CellularJitter = FLanes::Set(Settings.CellularJitter);
+
+	FInt XPrimed = FLanes::MulInt(FLanes::AddInt(XR, FLanes::SetInt(-1)), FLanes::SetInt(PrimeX));
+	const FInt YPrimedBase = FLanes::MulInt(FLanes::AddInt(YR, FLanes::SetInt(-1)), FLanes::SetInt(PrimeY));
+
+	for (int32 XOffset = -1; XOffset <= 1; ++XOffset)
+	{
+		const FFloat XI = FLanes::ToFloat(FLanes::AddInt(XR, FLanes::SetInt(XOffset)));
+		FInt YPrimed = YPrimedBase;
+
+		for (int32 YOffset = -1; YOffset <= 1; ++YOffset)
+		{
+			const FFloat YI = FLanes::ToFloat(FLanes::AddInt(YR, FLanes::SetInt(YOffset)));
+
+			const FInt HashValue = Hash(Seed, XPrimed, YPrimed);
+			const FInt Index = FLanes::And(HashValue, FLanes::SetInt(255 << 1));
+
+			const FFloat VecX = FLanes::Add(FLanes::Sub(XI, X), FLanes::Mul(FLanes::Gather(Settings.RandVecs2D, Index), CellularJitter));
+			const FFloat VecY = FLanes::Add(FLanes::Sub(YI, Y), FLanes::Mul(FLanes::Gather(Settings.RandVecs2D, FLanes::Or(Index, FLanes::SetInt(1))), CellularJitter));
+
+			FFloat NewDistance;
+			switch (Settings.CellularDistanceFunction)
+			{
+			default:
+			case FastNoiseLite::CellularDistanceFunction_Euclidean:
+			case FastNoiseLite::CellularDistanceFunction_EuclideanSq:
+				NewDistance = FLanes::Add(FLanes::Mul(VecX, VecX), FLanes::Mul(VecY, VecY));
+				break;
+			case FastNoiseLite::CellularDistanceFunction_Manhattan:
+				NewDistance = FLanes::Add(FLanes::Abs(VecX), FLanes::Abs(VecY));
+				break;
+			case FastNoiseLite::CellularDistanceFunction_Hybrid:
+				NewDistance = FLanes::Add(FLanes::Add(FLanes::Abs(VecX), FLanes::Abs(VecY)), FLanes::Add(FLanes::Mul(VecX, VecX), FLanes::Mul(VecY, VecY)));
+				break;
+			}
+
+			Distance1 = FLanes::Max(FLanes::Min(Distance1, NewDistance), Distance0);
+
+			const FFloat bCloser = FLanes::Less(NewDistance, Distance0);
+			Distance0 = FLanes::Select(bCloser, NewDistance, Distance0);
+			ClosestHash = FLanes::SelectInt(bCloser, HashValue, ClosestHash);
+
+			YPrimed = FLanes::AddInt(YPrimed, FLanes::SetInt(PrimeY));
+		}
+		XPrimed = FLanes::AddInt(XPrimed, FLanes::SetInt(PrimeX));
+	}
+
+	if (Settings.CellularDistanceFunction == FastNoiseLite::CellularDistanceFunction_Euclidean && Settings.CellularReturnType >= FastNoiseLite::CellularReturnType_Distance)
+	{
+		Distance0 = FLanes::Sqrt(Distance0);
+
+		if (Settings.CellularReturnType >= FastNoiseLite::CellularReturnType_Distance2)
+		{
+			Distance1 = FLanes::Sqrt(Distance1);
+		}
+	}
+
+	const FFloat One = FLanes::Set(1.0f);
+	switch (Settings.CellularReturnType)
+	{
+	case FastNoiseLite::CellularReturnType_CellValue:
+		return FLanes::Mul(FLanes::ToFloat(ClosestHash), FLanes::Set(1 / 2147483648.0f));
+	case FastNoiseLite::CellularReturnType_Distance:
+		return FLanes::Sub(Distance0, One);
+	case FastNoiseLite::CellularReturnType_Distance2:
+		return FLanes::Sub(Distance1, One);
+	case FastNoiseLite::CellularReturnType_Distance2Add:
+		return FLanes::Sub(FLanes::Mul(FLanes::Add(Distance1, Distance0), FLanes::Set(0.5f)), One);
+	case FastNoiseLite::CellularReturnType_Distance2Sub:
+		return FLanes::Sub(FLanes::Sub(Distance1, Distance0), One);
+	case FastNoiseLite::CellularReturnType_Distance2Mul:
+		return FLanes::Sub(FLanes::Mul(FLanes::Mul(Distance1, Distance0), FLanes::Set(0.5f)), One);
+	case FastNoiseLite::CellularReturnType_Distance2Div:
+		return FLanes::Sub(FLanes::Div(Distance0, Distance1), One);
+	default:
+		return FLanes::Set(0.0f);
+	}
+}
+
+FORCEINLINE FFloat GenNoiseSingle(const FNoiseBatchSettings& Settings, const int32 Seed, const FFloat X, const FFloat Y)
+{
+	const FInt SeedLanes = FLanes::SetInt(Seed);
+	return Settings.NoiseType == FastNoiseLite::NoiseType_Cellular
+		? SingleCellular(Settings, SeedLanes, X, Y)
+		: SinglePerlin(Settings, SeedLanes, X, Y);
+}
+
+FORCEINLINE FFloat GenNoiseSingle(const FNoiseBatchSettings& Settings, const int32 Seed, const FFloat X, const FFloat Y, const FFloat Z)
+{
+	return SinglePerlin(Settings, FLanes::SetInt(Seed), X, Y, Z);
+}
+
+// FBm, a single octave with a bounding of 1 when the noise has no fractal
+FORCEINLINE FFloat GenFractalFBm(const FNoiseBatchSettings& Settings, FFloat X, FFloat Y)
+{
+	int32 Seed = Settings.Seed;
+	FFloat Sum = FLanes::Set(0.0f);
+	FFloat Amp = FLanes::Set(Settings.FractalBounding);
+
+	for (int32 Octave = 0; Octave < Settings.Octaves; ++Octave)
+	{
+		const FFloat Noise = GenNoiseSingle(Settings, Seed++, X, Y);
+		Sum = FLanes::Add(Sum, FLanes::Mul(Noise, Amp));
+		Amp = FLanes::Mul(Amp, Lerp(FLanes::Set(1.0f), FLanes::Mul(FLanes::Min(FLanes::Add(Noise, FLanes::Set(1.0f)), FLanes::Set(2.0f)), FLanes::Set(0.5f)), FLanes::Set(Settings.WeightedStrength)));
+
+		X = FLanes::Mul(X, FLanes::Set(Settings.Lacunarity));
+		Y = FLanes::Mul(Y, FLanes::Set(Settings.Lacunarity));
+		Amp = FLanes::Mul(Amp, FLanes::Set(Settings.Gain));
+	}
+
+	return Sum;
+}
+
+FORCEINLINE FFloat GenFractalFBm(const FNoiseBatchSettings& Settings, FFloat X, FFloat Y, FFloat Z)
+{
+	int32 Seed = Settings.Seed;
+	FFloat Sum = FLanes::Set(0.0f);
+	FFloat Amp = FLanes::Set(Settings.FractalBounding);
+
+	for (int32 Octave = 0; Octave < Settings.Octaves; ++Octave)
+	{
+		const FFloat Noise = GenNoiseSingle(Settings, Seed++, X, Y, Z);
+		Sum = FLanes::Add(Sum, FLanes::Mul(Noise, Amp));
+		Amp = FLanes::Mul(Amp, Lerp(FLanes::Set(1.0f), FLanes::Mul(FLanes::Add(Noise, FLanes::Set(1.0f)), FLanes::Set(0.5f)), FLanes::Set(Settings.WeightedStrength)));
+
+		X = FLanes::Mul(X, FLanes::Set(Settings.Lacunarity));
+		Y = FLanes::Mul(Y, FLanes::Set(Settings.Lacunarity));
+		Z = FLanes::Mul(Z, FLanes::Set(Settings.Lacunarity));
+		Amp = FLanes::Mul(Amp, FLanes::Set(Settings.Gain));
+	}
+
+	return Sum;
+}
+
+// Writes the first Count lanes, the rest of a row that is not a multiple of the width is dropped
+FORCEINLINE void StoreRow(float* Out, const FFloat Value, const int32 Count)
+{
+	if (Count == FLanes::Width)
+	{
+		FLanes::Store(Out, Value);
+	}
+	else
+	{
+		float Lanes[FLanes::Width];
+		FLanes::Store(Lanes, Value);
+		FMemory::Memcpy(Out, Lanes, Count * sizeof(float));
+	}
+}
+
+void GenerateGrid2D(const FNoiseBatchSettings& Settings, float* Out, const int32 SizeX, const int32 SizeY,
+	const float X0, const float Y0, const float Step)
+{
+	const FFloat Frequency = FLanes::Set(Settings.Frequency);
+
+	for (int32 Y = 0; Y < SizeY; ++Y)
+	{
+		const FFloat YPos = FLanes::Mul(FLanes::Set(Y0 + Y * Step), Frequency);
+
+		for (int32 X = 0; X < SizeX; X += FLanes::Width)
+		{
+			const FFloat XIndex = FLanes::ToFloat(FLanes::AddInt(FLanes::SetInt(X), FLanes::Ramp()));
+			const FFloat XPos = FLanes::Mul(FLanes::Add(FLanes::Set(X0), FLanes::Mul(XIndex, FLanes::Set(Step))), Frequency);
+
+			StoreRow(Out + Y * SizeX + X, GenFractalFBm(Settings, XPos, YPos), FMath::Min<int32>(FLanes::Width, SizeX - X));
+		}
+	}
+}
+
+void GenerateGrid3D(const FNoiseBatchSettings& Settings, float* Out, const int32 SizeX, const int32 SizeY, const int32 SizeZ,
+	const float X0, const float Y0, const float Z0, const float Step)
+{
+	const FFloat Frequency = FLanes::Set(Settings.Frequency);
+
+	for (int32 Z = 0; Z < SizeZ; ++Z)
+	{
+		const FFloat ZPos = FLanes::Mul(FLanes::Set(Z0 + Z * Step), Frequency);
+
+		for (int32 Y = 0; Y < SizeY; ++Y)
+		{
+			const FFloat YPos = FLanes::Mul(FLanes::Set(Y0 + Y * Step), Frequency);
+			float* Row = Out + (Z * SizeY + Y) * SizeX;
+
+			for (int32 X = 0; X < SizeX; X += FLanes::Width)
+			{
+				const FFloat XIndex = FLanes::ToFloat(FLanes::AddInt(FLanes::SetInt(X), FLanes::Ramp()));
+				const FFloat XPos = FLanes::Mul(FLanes::Add(FLanes::Set(X0), FLanes::Mul(XIndex, FLanes::Set(Step))), Frequency);
+
+				StoreRow(Row + X, GenFractalFBm(Settings, XPos, YPos, ZPos), FMath::Min<int32>(FLanes::Width, SizeX - X));
+			}
+		}
+	}
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Palette-compressed voxel container.
+ *
+ * Every distinct value is stored once in a per-chunk palette and each voxel holds a bit-packed
+ * index into that palette, so memory scales with block variety instead of chunk volume.
+ * Index widths are powers of two (1, 2, 4, 8, 16 or 32 bits) so an index never straddles a word.
+ * A palette with a single entry keeps no index words at all, which makes all-air or all-stone
+ * chunks cost a single element.
+ */
+template <typename ElementType>
+class TPalettedBlockStorage
+{
+public:
+	TPalettedBlockStorage() = default;
+
+	// Resizes the storage to InNum voxels all holding Value
+	void Init(const int32 InNum, const ElementType& Value)
+	{
+		NumElements = InNum;
+		Fill(Value);
+	}
+
+	// Sets every voxel to Value and drops the index words
+	void Fill(const ElementType& Value)
+	{
+		Palette.Reset();
+		Palette.Add(Value);
+		Words.Empty();
+		BitsPerIndex = 0;
+		IndicesPerWordLog2 = 0;
+	}
+
+	int32 Num() const { return NumElements; }
+
+	bool IsUniform() const { return BitsPerIndex == 0; }
+
+	int32 GetPaletteSize() const { return Palette.Num(); }
+
+	int32 GetBitsPerIndex() const { return BitsPerIndex; }
+
+	const TArray<ElementType>& GetPalette() const { return Palette; }
+
+	// Position of the voxel's value in GetPalette
+	int32 GetPaletteIndexAt(const int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < NumElements);
+		return BitsPerIndex == 0 ? 0 : GetPaletteIndex(Index);
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Palette.GetAllocatedSize() + Words.GetAllocatedSize();
+	}
+
+	const ElementType& Get(const int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < NumElements);
+		return BitsPerIndex == 0 ? Palette[0] : Palette[GetPaletteIndex(Index)];
+	}
+
+	void Set(const int32 Index, const ElementType& Value)
+	{
+		checkSlow(Index >= 0 && Index < NumElements);
+
+		int32 PaletteIndex = Palette.IndexOfByKey(Value);
+		if (PaletteIndex == INDEX_NONE)
+		{
+			PaletteIndex = Palette.Add(Value);
+
+			// The palette outgrew the current index width, widen every index
+			if (Palette.Num() > (1 << BitsPerIndex))
+			{
+				Repack(BitsForPaletteSize(Palette.Num()), nullptr);
+			}
+		}
+
+		if (BitsPerIndex != 0)
+		{
+			SetPaletteIndex(Index, PaletteIndex);
+		}
+	}
+
+	/**
+	 * Replaces the palette and points every voxel at its first entry, SetRun then writes the
+	 * indices. Lets a saved chunk be decoded without searching the palette for every voxel.
+	 */
+	void InitPalette(TArrayView<const ElementType> InPalette)
+	{
+		check(InPalette.Num() > 0);
+		Palette.Reset();
+		Palette.Append(InPalette.GetData(), InPalette.Num());
+		Words.Empty();
+		BitsPerIndex = 0;
+		IndicesPerWordLog2 = 0;
+		Repack(BitsForPaletteSize(Palette.Num()), nullptr);
+	}
+
+	// Points Count voxels from Start at an entry of the palette set by InitPalette
+	void SetRun(const int32 Start, const int32 Count, const int32 PaletteIndex)
+	{
+		checkSlow(Start >= 0 && Start + Count <= NumElements && PaletteIndex < Palette.Num());
+		if (BitsPerIndex == 0)
+		{
+			return;
+		}
+
+		for (int32 Index = Start; Index < Start + Count; ++Index)
+		{
+			SetPaletteIndex(Index, PaletteIndex);
+		}
+	}
+
+	/**
+	 * Drops palette entries no voxel references any more and shrinks the index width to match.
+	 * Generation replaces many block states (e.g. grass turned into sand by the biome pass),
+	 * so this is worth calling once a chunk has finished generating.
+	 */
+	void Compact()
+	{
+		if (BitsPerIndex == 0)
+		{
+			return;
+		}
+
+		TArray<int32> Remap;
+		Remap.Init(INDEX_NONE, Palette.Num());
+
+		TArray<ElementType> NewPalette;
+		for (int32 i = 0; i < NumElements; ++i)
+		{
+			const int32 OldIndex = GetPaletteIndex(i);
+			if (Remap[OldIndex] == INDEX_NONE)
+			{
+				Remap[OldIndex] = NewPalette.Add(Palette[OldIndex]);
+			}
+		}
+
+		if (NewPalette.Num() == Palette.Num())
+		{
+			return;
+		}
+
+		Repack(BitsForPaletteSize(NewPalette.Num()), &Remap);
+		Palette = MoveTemp(NewPalette);
+	}
+
+private:
+	static int32 BitsForPaletteSize(const int32 PaletteSize)
+	{
+		if (PaletteSize <= 1)
+		{
+			return 0;
+		}
+
+		int32 Bits = 1;
+		while ((int64(1) << Bits) < PaletteSize)
+		{
+			Bits *= 2;
+		}
+		check(Bits <= 32);
+		return Bits;
+	}
+
+	int32 GetPaletteIndex(const int32 Index) const
+	{
+		const uint64 Word = Words[Index >> IndicesPerWordLog2];
+		const int32 Shift = (Index & ((1 << IndicesPerWordLog2) - 1)) * BitsPerIndex;
+		return static_cast<int32>((Word >> Shift) & ((uint64(1) << BitsPerIndex) - 1));
+	}
+
+	void SetPaletteIndex(const int32 Index, const int32 PaletteIndex)
+	{
+		uint64& Word = Words[Index >> IndicesPerWordLog2];
+		const int32 Shift = (Index & ((1 << IndicesPerWordLog2) - 1)) * BitsPerIndex;
+		const uint64 Mask = ((uint64(1) << BitsPerIndex) - 1) << Shift;
+		Word = (Word & ~Mask) | ((uint64(PaletteIndex) << Shift) & Mask);
+	}
+
+	// Rewrites every index with NewBits per entry, optionally remapping palette indices
+	void Repack(const int32 NewBits, const TArray<int32>* Remap)
+	{
+		TArray<uint64> OldWords = MoveTemp(Words);
+		const int32 OldBits = BitsPerIndex;
+		const int32 OldIndicesPerWordLog2 = IndicesPerWordLog2;
+
+		BitsPerIndex = NewBits;
+		Words.Reset();
+
+		if (NewBits == 0)
+		{
+			IndicesPerWordLog2 = 0;
+			return;
+		}
+
+		IndicesPerWordLog2 = 6 - FMath::FloorLog2(NewBits);
+		Words.SetNumZeroed((NumElements + (1 << IndicesPerWordLog2) - 1) >> IndicesPerWordLog2);
+
+		if (OldBits == 0)
+		{
+			// Everything referenced palette entry 0, which is already encoded by the zeroed words
+			return;
+		}
+
+		const uint64 OldMask = (uint64(1) << OldBits) - 1;
+		for (int32 i = 0; i < NumElements; ++i)
+		{
+			const uint64 Word = OldWords[i >> OldIndicesPerWordLog2];
+			const int32 Shift = (i & ((1 << OldIndicesPerWordLog2) - 1)) * OldBits;
+			int32 PaletteIndex = static_cast<int32>((Word >> Shift) & OldMask);
+			if (Remap)
+			{
+				PaletteIndex = (*Remap)[PaletteIndex];
+			}
+			SetPaletteIndex(i, PaletteIndex);
+		}
+	}
+
+	TArray<ElementType> Palette;
+	TArray<uint64> Words;
+	int32 NumElements = 0;
+	int32 BitsPerIndex = 0;
+	int32 IndicesPerWordLog2 = 0;
+};
@@ -5,38 +5,29 @@
 
 FIntVector UVoxelFunctionLibrary::WorldToBlockPosition(const FVector& Position)
 {
-	return FIntVector(Position) / 100;
+	// Floor rather than truncate so negative positions land in the block below them
+	return FIntVector(
+		FMath::FloorToInt(Position.X / 100),
+		FMath::FloorToInt(Position.Y / 100),
+		FMath::FloorToInt(Position.Z / 100)
+	);
 }
 
 FIntVector UVoxelFunctionLibrary::WorldToLocalBlockPosition(const FVector& Position, const int ChunkSize)
 {
 	const auto ChunkPos = WorldToChunkPosition(Position, ChunkSize);
 
-	auto Result = WorldToBlockPosition(Position) - ChunkPos * ChunkSize;
-
-	// Negative Normalization
-	if (ChunkPos.X < 0) Result.X--;
-	if (ChunkPos.Y < 0) Result.Y--;
-	if (ChunkPos.Z < 0) Result.Z--;
-
-	return Result;
+	return WorldToBlockPosition(Position) - ChunkPos * ChunkSize;
 }
 
 FIntVector UVoxelFunctionLibrary::WorldToChunkPosition(const FVector& Position, const int ChunkSize)
 {
-	FIntVector Result;
-
 	const int Factor = ChunkSize * 100;
-	const auto IntPosition = FIntVector(Position);
-
-	if (IntPosition.X < 0) Result.X = (int)(Position.X / Factor) - 1;
-	else Result.X = (int)(Position.X / Factor);
-
-	if (IntPosition.Y < 0) Result.Y = (int)(Position.Y / Factor) - 1;
-	else Result.Y = (int)(Position.Y / Factor);
-
-	if (IntPosition.Z < 0) Result.Z = (int)(Position.Z / Factor) - 1;
-	else Result.Z = (int)(Position.Z / Factor);
 
-	return Result;
+	// Floor so that exact negative multiples of the chunk size start a chunk instead of ending one
+	return FIntVector(
+		FMath::FloorToInt(Position.X / Factor),
+		FMath::FloorToInt(Position.Y / Factor),
+		FMath::FloorToInt(Position.Z / Factor)
+	);
 }
\ No newline at end of file
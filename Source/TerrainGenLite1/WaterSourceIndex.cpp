@@ -0,0 +1,452 @@
+#include "WaterSourceIndex.h"
+
+#include "ChunkData.h"
+
+// Squared distance from Point to the closest integer position in [Min, Max]
+static double GetBoxDistanceSquared(const FVector& Point, const FIntVector& Min, const FIntVector& Max)
+{
+	double DistanceSquared = 0.0;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const double Delta = FMath::Max3(Min[Axis] - Point[Axis], 0.0, Point[Axis] - Max[Axis]);
+		DistanceSquared += Delta * Delta;
+	}
+	return DistanceSquared;
+}
+
+// Face neighbours, the distance fields count steps between them
+static const FIntVector FaceSteps[6] = {
+	FIntVector(1, 0, 0), FIntVector(0, 1, 0), FIntVector(0, 0, 1),
+	FIntVector(-1, 0, 0), FIntVector(0, -1, 0), FIntVector(0, 0, -1)
+};
+
+static int32 FloorDivide(const int32 Value, const int32 Divisor)
+{
+	return Value >= 0 ? Value / Divisor : (Value - Divisor + 1) / Divisor;
+}
+
+void FChunkWaterSources::Build(const FChunkData& Chunk)
+{
+	ChunkSize = Chunk.ChunkSize;
+	CellsPerAxis = FMath::DivideAndRoundUp(ChunkSize, CellSize);
+	Count = 0;
+
+	CellCounts.Init(0, CellsPerAxis * CellsPerAxis * CellsPerAxis);
+	Mask.Empty();
+	Distance.Empty();
+
+	// Uniform chunks hold no index words, a single palette check covers them
+	if (Chunk.Blocks.IsUniform() && !IsWaterSource(Chunk.Blocks.Get(0)))
+		return;
+
+	TArray<FIntVector> Pending;
+
+	FIntVector Position;
+	for (Position.Z = 0; Position.Z < ChunkSize; ++Position.Z)
+	{
+		for (Position.Y = 0; Position.Y < ChunkSize; ++Position.Y)
+		{
+			for (Position.X = 0; Position.X < ChunkSize; ++Position.X)
+			{
+				if (IsWaterSource(Chunk.Blocks.Get(GetIndex(Position))))
+				{
+					// Dry chunks never allocate the per voxel arrays
+					if (Count == 0)
+					{
+						Mask.Init(false, ChunkSize * ChunkSize * ChunkSize);
+						Distance.Init(FarDistance, ChunkSize * ChunkSize * ChunkSize);
+					}
+
+					Mask[GetIndex(Position)] = true;
+					Distance[GetIndex(Position)] = 0;
+					++CellCounts[GetCellIndex(Position)];
+					++Count;
+					Pending.Add(Position);
+				}
+			}
+		}
+	}
+
+	// Multi-source BFS, every voxel is reached first from its closest water voxel
+	for (int32 Head = 0; Head < Pending.Num(); ++Head)
+	{
+		const FIntVector Current = Pending[Head];
+		const uint8 NextDistance = Distance[GetIndex(Current)] + 1;
+		if (NextDistance > MaxWaterDistance)
+			continue;
+
+		for (const FIntVector& Step : FaceSteps)
+		{
+			const FIntVector Neighbour = Current + Step;
+			if (Neighbour.X < 0 || Neighbour.Y < 0 || Neighbour.Z < 0 || Neighbour.X >= ChunkSize || Neighbour.Y >= ChunkSize || Neighbour.Z >= ChunkSize)
+				continue;
+
+			uint8& NeighbourDistance = Distance[GetIndex(Neighbour)];
+			if (NextDistance < NeighbourDistance)
+			{
+				NeighbourDistance = NextDistance;
+				Pending.Add(Neighbour);
+			}
+		}
+	}
+}
+
+bool FChunkWaterSources::Set(const FIntVector& Position, const bool bIsWater)
+{
+	if (Mask.Num() == 0)
+	{
+		if (!bIsWater)
+			return false;
+		Mask.Init(false, ChunkSize * ChunkSize * ChunkSize);
+	}
+
+	const int32 Index = GetIndex(Position);
+	if (Mask[Index] == bIsWater)
+		return false;
+
+	Mask[Index] = bIsWater;
+	const int32 Delta = bIsWater ? 1 : -1;
+	CellCounts[GetCellIndex(Position)] += Delta;
+	Count += Delta;
+	return true;
+}
+
+void FChunkWaterSources::SetDistance(const FIntVector& Position, const uint8 Value)
+{
+	if (Distance.Num() == 0)
+	{
+		if (Value == FarDistance)
+			return;
+		Distance.Init(FarDistance, ChunkSize * ChunkSize * ChunkSize);
+	}
+	Distance[GetIndex(Position)] = Value;
+}
+
+bool FChunkWaterSources::FindNearest(const FVector& Point, double& InOutBestDistanceSquared, FIntVector& OutPosition) const
+{
+	bool bFound = false;
+
+	FIntVector Cell;
+	for (Cell.Z = 0; Cell.Z < CellsPerAxis; ++Cell.Z)
+	{
+		for (Cell.Y = 0; Cell.Y < CellsPerAxis; ++Cell.Y)
+		{
+			for (Cell.X = 0; Cell.X < CellsPerAxis; ++Cell.X)
+			{
+				const FIntVector Min = Cell * CellSize;
+				if (CellCounts[GetCellIndex(Min)] == 0)
+					continue;
+
+				// The last cell along an axis is cut short by chunk sizes that are not a multiple of CellSize
+				const FIntVector Max(
+					FMath::Min(Min.X + CellSize, ChunkSize) - 1,
+					FMath::Min(Min.Y + CellSize, ChunkSize) - 1,
+					FMath::Min(Min.Z + CellSize, ChunkSize) - 1);
+				if (GetBoxDistanceSquared(Point, Min, Max) >= InOutBestDistanceSquared)
+					continue;
+
+				FIntVector Position;
+				for (Position.Z = Min.Z; Position.Z <= Max.Z; ++Position.Z)
+				{
+					for (Position.Y = Min.Y; Position.Y <= Max.Y; ++Position.Y)
+					{
+						for (Position.X = Min.X; Position.X <= Max.X; ++Position.X)
+						{
+							if (!Mask[GetIndex(Position)])
+								continue;
+
+							const double DistanceSquared = FVector::DistSquared(FVector(Position), Point);
+							if (DistanceSquared < InOutBestDistanceSquared)
+							{
+								InOutBestDistanceSquared = DistanceSquared;
+								OutPosition = Position;
+								bFound = true;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return bFound;
+}
+
+FWaterSourceIndex::FWaterSourceIndex(const int32 InChunkSize)
+	: ChunkSize(InChunkSize)
+{
+}
+
+void FWaterSourceIndex::AddChunk(const FIntVector& ChunkPosition, FChunkWaterSources& Sources)
+{
+	RemoveChunk(ChunkPosition);
+
+	NumWaterBlocks += Sources.Count;
+	ChunkSources.Add(ChunkPosition, &Sources);
+
+	// Relax both sides of every shared face: our border layers into the neighbours and theirs into us
+	TArray<FIntVector> Pending;
+	for (int32 Face = 0; Face < 6; ++Face)
+	{
+		const int32 Axis = Face % 3;
+		const FIntVector NeighbourPosition = ChunkPosition + FaceSteps[Face];
+		FChunkWaterSources* const* Neighbour = ChunkSources.Find(NeighbourPosition);
+		if (!Neighbour)
+			continue;
+
+		const FIntVector Origin = ChunkPosition * ChunkSize;
+		const FIntVector NeighbourOrigin = NeighbourPosition * ChunkSize;
+
+		FIntVector Position = FIntVector::ZeroValue;
+		for (Position[(Axis + 2) % 3] = 0; Position[(Axis + 2) % 3] < ChunkSize; ++Position[(Axis + 2) % 3])
+		{
+			for (Position[(Axis + 1) % 3] = 0; Position[(Axis + 1) % 3] < ChunkSize; ++Position[(Axis + 1) % 3])
+			{
+				// Our layer on the face, and the neighbour's layer facing it
+				Position[Axis] = Face < 3 ? ChunkSize - 1 : 0;
+				if (Sources.GetDistance(Position) < FChunkWaterSources::MaxWaterDistance)
+				{
+					Pending.Add(Origin + Position);
+				}
+
+				Position[Axis] = Face < 3 ? 0 : ChunkSize - 1;
+				if ((*Neighbour)->GetDistance(Position) < FChunkWaterSources::MaxWaterDistance)
+				{
+					Pending.Add(NeighbourOrigin + Position);
+				}
+			}
+		}
+	}
+
+	PropagateDistances(Pending);
+}
+
+void FWaterSourceIndex::RemoveChunk(const FIntVector& ChunkPosition)
+{
+	if (FChunkWaterSources* const* Sources = ChunkSources.Find(ChunkPosition))
+	{
+		NumWaterBlocks -= (*Sources)->Count;
+		ChunkSources.Remove(ChunkPosition);
+	}
+}
+
+void FWaterSourceIndex::Reset()
+{
+	ChunkSources.Reset();
+	NumWaterBlocks = 0;
+}
+
+template <typename FunctorType>
+void FWaterSourceIndex::ForEachChunkInBox(const FIntVector& Min, const FIntVector& Max, FunctorType&& Visit) const
+{
+	FIntVector ChunkPosition;
+	for (ChunkPosition.Z = FloorDivide(Min.Z, ChunkSize); ChunkPosition.Z <= FloorDivide(Max.Z, ChunkSize); ++ChunkPosition.Z)
+	{
+		for (ChunkPosition.Y = FloorDivide(Min.Y, ChunkSize); ChunkPosition.Y <= FloorDivide(Max.Y, ChunkSize); ++ChunkPosition.Y)
+		{
+			for (ChunkPosition.X = FloorDivide(Min.X, ChunkSize); ChunkPosition.X <= FloorDivide(Max.X, ChunkSize); ++ChunkPosition.X)
+			{
+				// A chunk without a distance field is FarDistance and dry everywhere, nothing to clear or seed
+				FChunkWaterSources* Sources = ChunkSources.FindRef(ChunkPosition);
+				if (!Sources || Sources->Distance.Num() == 0)
+					continue;
+
+				const FIntVector Origin = ChunkPosition * ChunkSize;
+				FIntVector LocalMin;
+				FIntVector LocalMax;
+				for (int32 Axis = 0; Axis < 3; ++Axis)
+				{
+					LocalMin[Axis] = FMath::Max(Min[Axis] - Origin[Axis], 0);
+					LocalMax[Axis] = FMath::Min(Max[Axis] - Origin[Axis], ChunkSize - 1);
+				}
+				Visit(*Sources, Origin, LocalMin, LocalMax);
+			}
+		}
+	}
+}
+
+void FWaterSourceIndex::UpdateBlocks(const FIntVector& ChunkPosition, const TArray<FIntVector>& Positions, const FChunkData& Chunk)
+{
+	FChunkWaterSources* Sources = ChunkSources.FindRef(ChunkPosition);
+	if (!Sources)
+		return;
+
+	const FIntVector Origin = ChunkPosition * ChunkSize;
+
+	TArray<FIntVector> Pending;
+	TArray<FIntVector> Removed;
+	for (const FIntVector& Position : Positions)
+	{
+		const bool bIsWater = FChunkWaterSources::IsWaterSource(Chunk.GetBlockType(Position));
+		if (!Sources->Set(Position, bIsWater))
+			continue;
+
+		NumWaterBlocks += bIsWater ? 1 : -1;
+		if (bIsWater)
+		{
+			Sources->SetDistance(Position, 0);
+			Pending.Add(Origin + Position);
+		}
+		else
+		{
+			Removed.Add(Origin + Position);
+		}
+	}
+
+	// Distances only ever shrink while propagating, so everything a removed water voxel may have
+	// lowered is cleared first. A voxel farther than MaxWaterDistance in any axis cannot depend on it,
+	// the boxes of the whole batch are merged into one and walked per chunk
+	if (Removed.Num() > 0)
+	{
+		FIntVector RemovedMin = Removed[0];
+		FIntVector RemovedMax = Removed[0];
+		for (const FIntVector& Center : Removed)
+		{
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				RemovedMin[Axis] = FMath::Min(RemovedMin[Axis], Center[Axis]);
+				RemovedMax[Axis] = FMath::Max(RemovedMax[Axis], Center[Axis]);
+			}
+		}
+
+		const FIntVector Radius(FChunkWaterSources::MaxWaterDistance);
+		ForEachChunkInBox(RemovedMin - Radius, RemovedMax + Radius, [](FChunkWaterSources& Owner, const FIntVector&, const FIntVector& Min, const FIntVector& Max)
+		{
+			FIntVector Local;
+			for (Local.Z = Min.Z; Local.Z <= Max.Z; ++Local.Z)
+			{
+				for (Local.Y = Min.Y; Local.Y <= Max.Y; ++Local.Y)
+				{
+					for (Local.X = Min.X; Local.X <= Max.X; ++Local.X)
+					{
+						const int32 Index = Owner.GetIndex(Local);
+						Owner.Distance[Index] = Owner.Mask.Num() > 0 && Owner.Mask[Index] ? 0 : FChunkWaterSources::FarDistance;
+					}
+				}
+			}
+		});
+
+		// Then refilled from everything still valid in and right around the cleared box
+		ForEachChunkInBox(RemovedMin - Radius - FIntVector(1), RemovedMax + Radius + FIntVector(1), [&Pending](FChunkWaterSources& Owner, const FIntVector& Origin, const FIntVector& Min, const FIntVector& Max)
+		{
+			FIntVector Local;
+			for (Local.Z = Min.Z; Local.Z <= Max.Z; ++Local.Z)
+			{
+				for (Local.Y = Min.Y; Local.Y <= Max.Y; ++Local.Y)
+				{
+					for (Local.X = Min.X; Local.X <= Max.X; ++Local.X)
+					{
+						if (Owner.Distance[Owner.GetIndex(Local)] < FChunkWaterSources::MaxWaterDistance)
+						{
+							Pending.Add(Origin + Local);
+						}
+					}
+				}
+			}
+		});
+	}
+
+	PropagateDistances(Pending);
+}
+
+FChunkWaterSources* FWaterSourceIndex::FindChunk(const FIntVector& Position, FIntVector& OutLocalPosition) const
+{
+	const FIntVector ChunkPosition(
+		FloorDivide(Position.X, ChunkSize),
+		FloorDivide(Position.Y, ChunkSize),
+		FloorDivide(Position.Z, ChunkSize));
+
+	OutLocalPosition = Position - ChunkPosition * ChunkSize;
+	return ChunkSources.FindRef(ChunkPosition);
+}
+
+void FWaterSourceIndex::PropagateDistances(TArray<FIntVector>& Pending) const
+{
+	// Seeds arrive with mixed distances, so a voxel may be lowered more than once before it settles
+	for (int32 Head = 0; Head < Pending.Num(); ++Head)
+	{
+		const FIntVector Current = Pending[Head];
+
+		FIntVector Local;
+		const FChunkWaterSources* Owner = FindChunk(Current, Local);
+		const uint8 NextDistance = Owner->GetDistance(Local) + 1;
+		if (NextDistance > FChunkWaterSources::MaxWaterDistance)
+			continue;
+
+		for (const FIntVector& Step : FaceSteps)
+		{
+			FIntVector NeighbourLocal;
+			FChunkWaterSources* NeighbourOwner = FindChunk(Current + Step, NeighbourLocal);
+			if (!NeighbourOwner)
+				continue;
+
+			if (NextDistance < NeighbourOwner->GetDistance(NeighbourLocal))
+			{
+				NeighbourOwner->SetDistance(NeighbourLocal, NextDistance);
+				Pending.Add(Current + Step);
+			}
+		}
+	}
+}
+
+bool FWaterSourceIndex::FindNearest(const FVector& Point, FIntVector& OutPosition) const
+{
+	double BestDistanceSquared = TNumericLimits<double>::Max();
+	return FindNearestWithin(Point, BestDistanceSquared, OutPosition);
+}
+
+double FWaterSourceIndex::GetDistanceToWater(const FVector& Point, const double MaxDistance) const
+{
+	// Chunks and cells farther than MaxDistance are never opened
+	double BestDistanceSquared = MaxDistance * MaxDistance;
+	FIntVector Position;
+	if (!FindNearestWithin(Point, BestDistanceSquared, Position))
+		return MaxDistance;
+	return FMath::Sqrt(BestDistanceSquared);
+}
+
+bool FWaterSourceIndex::FindNearestWithin(const FVector& Point, double& InOutBestDistanceSquared, FIntVector& OutPosition) const
+{
+	if (NumWaterBlocks == 0)
+		return false;
+
+	struct FCandidate
+	{
+		double DistanceSquared;
+		FIntVector ChunkPosition;
+		const FChunkWaterSources* Sources;
+	};
+
+	TArray<FCandidate, TInlineAllocator<128>> Candidates;
+	for (const TPair<FIntVector, FChunkWaterSources*>& Pair : ChunkSources)
+	{
+		if (Pair.Value->Count == 0)
+			continue;
+
+		const FIntVector Min = Pair.Key * ChunkSize;
+		const double DistanceSquared = GetBoxDistanceSquared(Point, Min, Min + FIntVector(ChunkSize - 1));
+		if (DistanceSquared < InOutBestDistanceSquared)
+		{
+			Candidates.Add({ DistanceSquared, Pair.Key, Pair.Value });
+		}
+	}
+
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.DistanceSquared < B.DistanceSquared; });
+
+	bool bFound = false;
+	for (const FCandidate& Candidate : Candidates)
+	{
+		if (Candidate.DistanceSquared >= InOutBestDistanceSquared)
+			break;
+
+		const FIntVector ChunkOrigin = Candidate.ChunkPosition * ChunkSize;
+		FIntVector LocalPosition;
+		if (Candidate.Sources->FindNearest(Point - FVector(ChunkOrigin), InOutBestDistanceSquared, LocalPosition))
+		{
+			OutPosition = ChunkOrigin + LocalPosition;
+			bFound = true;
+		}
+	}
+
+	return bFound;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums.h"
+
+class FChunkData;
+
+/**
+ * Water voxels of one chunk as a bitset indexed like FChunkData::GetBlockIndex, plus the number
+ * of water voxels per cell of CellSize^3 so nearest queries skip dry cells without reading bits.
+ *
+ * Also keeps the distance of every voxel to the closest water voxel in face steps, capped at
+ * MaxWaterDistance, so per block humidity is a single lookup.
+ *
+ * The per voxel arrays of a chunk without water stay empty until water is placed in or reaches it,
+ * empty meaning no water and FarDistance everywhere.
+ */
+struct FChunkWaterSources
+{
+	static constexpr int32 CellSize = 8;
+
+	// Humidity falls from 1 next to water to 0 at this many voxels, 1000 units at the default BlockSize
+	static constexpr uint8 MaxWaterDistance = 10;
+	static constexpr uint8 FarDistance = 255;
+
+	int32 ChunkSize = 0;
+	int32 CellsPerAxis = 0;
+	int32 Count = 0;
+
+	TBitArray<> Mask;
+	TArray<uint16> CellCounts;
+	TArray<uint8> Distance;
+
+	// Blocks nearest-water queries look for
+	static bool IsWaterSource(const EBlock Block)
+	{
+		return Block == EBlock::ShallowWater || Block == EBlock::DeepWater || Block == EBlock::Ice;
+	}
+
+	// Scans every voxel of the chunk and runs a multi-source BFS from its water, runs on the
+	// generation workers. Water in the neighbours is added by FWaterSourceIndex on upload
+	void Build(const FChunkData& Chunk);
+
+	// Updates a single voxel, returns false if it already had that state
+	bool Set(const FIntVector& Position, bool bIsWater);
+
+	bool IsWater(const FIntVector& Position) const { return Mask.Num() > 0 && Mask[GetIndex(Position)]; }
+
+	uint8 GetDistance(const FIntVector& Position) const { return Distance.Num() > 0 ? Distance[GetIndex(Position)] : FarDistance; }
+
+	// Allocates the distance field on the first voxel that comes within reach of water
+	void SetDistance(const FIntVector& Position, uint8 Value);
+
+	// 1 in and next to water, falling linearly to 0 at MaxWaterDistance
+	float GetHumidity(const FIntVector& Position) const
+	{
+		return 1.0f - FMath::Min<uint8>(GetDistance(Position), MaxWaterDistance) / float(MaxWaterDistance);
+	}
+
+	// Finds a water voxel closer to Point than sqrt(InOutBestDistanceSquared), in chunk-local voxel units
+	bool FindNearest(const FVector& Point, double& InOutBestDistanceSquared, FIntVector& OutPosition) const;
+
+	int32 GetIndex(const FIntVector& Position) const { return (Position.Z * ChunkSize + Position.Y) * ChunkSize + Position.X; }
+	int32 GetCellIndex(const FIntVector& Position) const
+	{
+		return ((Position.Z / CellSize) * CellsPerAxis + Position.Y / CellSize) * CellsPerAxis + Position.X / CellSize;
+	}
+};
+
+/**
+ * Water sources of every generated chunk, keyed by chunk coordinate. Game thread only; chunks
+ * are added on upload, kept up to date by voxel edits and dropped when they stream out. The
+ * sources live in the chunk data, the index only points at them while the chunk is loaded.
+ *
+ * The distance fields are stitched across chunk borders: an added chunk and its face neighbours
+ * relax each other's border voxels, and edits propagate into whichever loaded chunks they reach.
+ *
+ * Positions are global voxel coordinates, ChunkPosition * ChunkSize + the chunk-local position.
+ */
+class FWaterSourceIndex
+{
+public:
+	explicit FWaterSourceIndex(int32 InChunkSize);
+
+	void AddChunk(const FIntVector& ChunkPosition, FChunkWaterSources& Sources);
+	void RemoveChunk(const FIntVector& ChunkPosition);
+	void Reset();
+
+	// Keeps the index and the distance fields in sync with edited blocks, Positions are local to the chunk
+	void UpdateBlocks(const FIntVector& ChunkPosition, const TArray<FIntVector>& Positions, const FChunkData& Chunk);
+
+	// Nearest water voxel to Point, in global voxel units. Returns false if no loaded chunk has water
+	bool FindNearest(const FVector& Point, FIntVector& OutPosition) const;
+
+	// Distance in voxels to the nearest water voxel, or MaxDistance if there is none closer
+	double GetDistanceToWater(const FVector& Point, double MaxDistance) const;
+
+	int32 GetNumWaterBlocks() const { return NumWaterBlocks; }
+
+private:
+	const int32 ChunkSize;
+	TMap<FIntVector, FChunkWaterSources*> ChunkSources;
+	int32 NumWaterBlocks = 0;
+
+	// Chunk holding a global voxel position, and the position inside it
+	FChunkWaterSources* FindChunk(const FIntVector& Position, FIntVector& OutLocalPosition) const;
+
+	// Calls Visit(Sources, ChunkOrigin, LocalMin, LocalMax) with the part of the global box [Min, Max]
+	// inside each loaded chunk with a distance field, bounds inclusive
+	template <typename FunctorType>
+	void ForEachChunkInBox(const FIntVector& Min, const FIntVector& Max, FunctorType&& Visit) const;
+
+	// Lowers the distance of the voxels around the queued ones until nothing changes, across chunks
+	void PropagateDistances(TArray<FIntVector>& Pending) const;
+
+	// Searches the chunks in order of their distance to Point, stops once none can beat the best so far
+	bool FindNearestWithin(const FVector& Point, double& InOutBestDistanceSquared, FIntVector& OutPosition) const;
+};